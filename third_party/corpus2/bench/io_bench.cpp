@@ -0,0 +1,130 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE and COPYING files for more details.
+*/
+
+/**
+ * @file io_bench.cpp
+ * @brief Read and write throughput of corpus formats.
+ *
+ * The corpus is read into memory once, then written to a file and read
+ * back from it in each of the compared formats. Reading goes through
+ * get_next_chunk, the way retraining and reanalysis read their corpora.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <libcorpus2/tagsetmanager.h>
+#include <libcorpus2/io/reader.h>
+#include <libcorpus2/io/writer.h>
+#include <libpwrutils/stagetimer.h>
+
+typedef boost::shared_ptr<Corpus2::Chunk> ChunkPtr;
+
+const std::string USAGE = "Usage: corpus2-io-bench TAGSET CORPUS [FORMAT [ROUNDS [COMPARED]]]\n\
+\n\
+Measures the speed of writing and reading a corpus (default format: ccl,\n\
+rounds: 3) in each of the compared formats (default: ccl,ccl:gz,bin,\n\
+separated by semicolons).\n";
+
+void report(const std::string& name, size_t tokens, boost::uint64_t start,
+		boost::uint64_t end)
+{
+	const double seconds = static_cast<double>(end - start) / 1e6;
+	std::cout << name << ": " << tokens << " tokens in " << seconds << " s";
+	if(seconds > 0)
+		std::cout << ", " << static_cast<size_t>(tokens / seconds) << " tokens/s";
+	std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 3) {
+		std::cerr << USAGE;
+		return EXIT_FAILURE;
+	}
+	const std::string tagset_name = argv[1];
+	const std::string corpus_path = argv[2];
+	const std::string format = argc > 3 ? argv[3] : "ccl";
+	const int rounds = argc > 4 ? boost::lexical_cast<int>(argv[4]) : 3;
+	const std::string compared = argc > 5 ? argv[5] : "ccl;ccl:gz;bin";
+
+	try {
+		const Corpus2::Tagset& tagset = Corpus2::get_named_tagset(tagset_name);
+		std::vector<ChunkPtr> chunks;
+		size_t tokens = 0;
+		boost::shared_ptr<Corpus2::TokenReader> reader =
+				Corpus2::TokenReader::create_path_reader(format, tagset, corpus_path);
+		while(ChunkPtr chunk = reader->get_next_chunk()) {
+			BOOST_FOREACH(const Corpus2::Sentence::Ptr& s, chunk->sentences()) {
+				tokens += s->size();
+			}
+			chunks.push_back(chunk);
+		}
+		reader.reset();
+		std::cout << chunks.size() << " chunks, " << tokens << " tokens" << std::endl;
+
+		std::vector<std::string> formats;
+		boost::algorithm::split(formats, compared, boost::is_any_of(";"));
+		const boost::filesystem::path tmp = boost::filesystem::temp_directory_path()
+				/ boost::filesystem::unique_path("corpus2-io-bench-%%%%%%%%");
+		BOOST_FOREACH(const std::string& f, formats) {
+			boost::uint64_t start = PwrNlp::monotonic_microseconds();
+			for(int round = 0; round < rounds; ++round) {
+				boost::shared_ptr<Corpus2::TokenWriter> writer =
+						Corpus2::TokenWriter::create_path_writer(f, tmp.string(), tagset);
+				BOOST_FOREACH(const ChunkPtr& chunk, chunks) {
+					writer->write_chunk(*chunk);
+				}
+			}
+			report(f + " write", tokens * rounds, start,
+					PwrNlp::monotonic_microseconds());
+			std::cout << f + " size: " << boost::filesystem::file_size(tmp)
+					  << " bytes" << std::endl;
+
+			size_t read_tokens = 0;
+			start = PwrNlp::monotonic_microseconds();
+			for(int round = 0; round < rounds; ++round) {
+				boost::shared_ptr<Corpus2::TokenReader> r =
+						Corpus2::TokenReader::create_path_reader(f, tagset, tmp.string());
+				while(ChunkPtr chunk = r->get_next_chunk()) {
+					BOOST_FOREACH(const Corpus2::Sentence::Ptr& s, chunk->sentences()) {
+						read_tokens += s->size();
+					}
+				}
+			}
+			report(f + " read", read_tokens, start,
+					PwrNlp::monotonic_microseconds());
+			if(read_tokens != tokens * rounds) {
+				std::cerr << "Error: " << f << " read back "
+						  << read_tokens / rounds << " tokens" << std::endl;
+			}
+		}
+		boost::filesystem::remove(tmp);
+	} catch(PwrNlp::PwrNlpError& e) {
+		std::cerr << "Error: " << e.info() << std::endl;
+		return EXIT_FAILURE;
+	} catch(std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
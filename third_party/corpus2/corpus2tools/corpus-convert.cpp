@@ -0,0 +1,103 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE and COPYING files for more details.
+*/
+
+#include <libcorpus2/tagsetmanager.h>
+#include <libcorpus2/io/reader.h>
+#include <libcorpus2/io/writer.h>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/program_options.hpp>
+
+#include <iostream>
+
+// not checking for HAVE_VERSION, there is no reason it shouldn't be there
+#include <libcorpus2/version.h>
+
+int main(int argc, char** argv)
+{
+	std::string tagset_load, input_format, output_format;
+	std::string input_file, output_file;
+	using boost::program_options::value;
+
+	boost::program_options::options_description desc("Allowed options");
+	desc.add_options()
+			("tagset,t", value(&tagset_load)->default_value("nkjp"),
+			 "tagset")
+			("input-format,i", value(&input_format)->default_value("ccl"),
+			 "input format, with options")
+			("output-format,o", value(&output_format)->default_value("bin"),
+			 "output format, with options")
+			("input", value(&input_file),
+			 "file to convert")
+			("output", value(&output_file),
+			 "file to write, standard output if not given")
+			("help,h", "Show help")
+			("version", "print version string")
+			;
+	boost::program_options::variables_map vm;
+	boost::program_options::positional_options_description p;
+	p.add("input", 1);
+	p.add("output", 1);
+
+	try {
+		boost::program_options::store(
+			boost::program_options::command_line_parser(argc, argv)
+			.options(desc).positional(p).run(), vm);
+	} catch (boost::program_options::error& e) {
+		std::cerr << e.what() << "\n";
+		return 2;
+	}
+	boost::program_options::notify(vm);
+
+	if (vm.count("help") || input_file.empty()) {
+		std::cout << "Usage: corpus-convert [options] INPUT [OUTPUT]\n";
+		std::cout << "Converts a corpus between formats, chunk by chunk.\n";
+		std::cout << "Converting to and from bin requires the same tagset.\n";
+		std::cout << desc << "\n";
+		std::cout << "Available readers: ";
+		std::cout << boost::algorithm::join(Corpus2::TokenReader::available_reader_types(), " ") << "\n";
+		std::cout << "Available writers: ";
+		std::cout << boost::algorithm::join(Corpus2::TokenWriter::available_writer_types(), " ") << "\n";
+		return 1;
+	}
+	if (vm.count("version")) {
+		std::cout << "corpus-convert (libcorpus2) " << LIBCORPUS2_VERSION << "\n";
+		return 0;
+	}
+
+	try {
+		const Corpus2::Tagset& tagset = Corpus2::get_named_tagset(tagset_load);
+		Corpus2::TokenReader::TokenReaderPtr reader =
+			Corpus2::TokenReader::create_path_reader(
+				input_format, tagset, input_file);
+		Corpus2::TokenWriter::TokenWriterPtr writer;
+		if (output_file.empty()) {
+			writer = Corpus2::TokenWriter::create_stream_writer(
+				output_format, std::cout, tagset);
+		} else {
+			writer = Corpus2::TokenWriter::create_path_writer(
+				output_format, output_file, tagset);
+		}
+		while (boost::shared_ptr<Corpus2::Chunk> chunk = reader->get_next_chunk()) {
+			writer->write_chunk(*chunk);
+		}
+		writer->finish();
+	} catch (PwrNlp::PwrNlpError& e) {
+		std::cerr << "Error: " << e.info() << "\n";
+		return 1;
+	}
+	return 0;
+}
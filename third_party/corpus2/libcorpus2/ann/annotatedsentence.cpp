@@ -35,6 +35,7 @@ Sentence::Ptr AnnotatedSentence::clone_shared() const
 {
 	boost::shared_ptr<AnnotatedSentence> copy;
 	copy = boost::make_shared<AnnotatedSentence>(id_);
+	copy->tokens_.reserve(tokens_.size());
 	BOOST_FOREACH(const Token* t, tokens_) {
 		copy->append(t->clone());
 	}
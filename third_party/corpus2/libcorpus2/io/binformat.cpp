@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE.CORPUS2, LICENSE.POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#include <libcorpus2/io/binformat.h>
+#include <libcorpus2/tagsetparser.h>
+#include <boost/crc.hpp>
+#include <sstream>
+
+namespace Corpus2 {
+namespace binformat {
+
+boost::uint32_t tagset_checksum(const Tagset& tagset)
+{
+	// the saved definition lists symbols in index order, so it changes
+	// whenever any mask would
+	std::stringstream ss;
+	TagsetParser::save_ini(tagset, ss);
+	const std::string def = ss.str();
+	boost::crc_32_type crc;
+	crc.process_bytes(def.data(), def.size());
+	return crc.checksum();
+}
+
+boost::uint64_t mask_to_int(const mask_t& mask)
+{
+	const mask_t low_bits(0xffffffffUL);
+	boost::uint64_t value = (mask >> 32).to_ulong() & 0xffffffffUL;
+	value <<= 32;
+	value |= (mask & low_bits).to_ulong();
+	return value;
+}
+
+mask_t int_to_mask(boost::uint64_t value)
+{
+	mask_t mask(static_cast<unsigned long>(value >> 32));
+	mask <<= 32;
+	mask |= mask_t(static_cast<unsigned long>(value & 0xffffffffUL));
+	return mask;
+}
+
+} /* end ns binformat */
+} /* end ns Corpus2 */
@@ -0,0 +1,99 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE.CORPUS2, LICENSE.POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#ifndef LIBCORPUS2_IO_BINFORMAT_H
+#define LIBCORPUS2_IO_BINFORMAT_H
+
+#include <libcorpus2/tag.h>
+#include <boost/cstdint.hpp>
+
+namespace Corpus2 {
+
+class Tagset;
+
+/**
+ * Layout of the binary corpus format ("bin") shared by BinReader and
+ * BinWriter.
+ *
+ * A file starts with a header, followed by sentence records, index
+ * tables and a fixed-size trailer pointing to the tables. Strings (orths,
+ * lemmas, ids and chunk attributes) are stored once in a string table and
+ * referred to by index. Tags are stored as raw POS and value masks, valid
+ * only within the tagset the file was written with, so the header holds a
+ * checksum of the tagset definition. All integers are in host byte order,
+ * a byte order mark in the header rejects files from other hosts.
+ *
+ * Header (24 bytes):
+ *   char[8] magic, uint32 version, uint32 byte order mark,
+ *   uint32 tagset checksum, uint32 reserved
+ * Sentence record:
+ *   uint32 token count, uint32 sentence id,
+ *   then for each token (8 bytes + lexemes):
+ *     uint32 orth, uint16 lexeme count, uint8 whitespace, uint8 reserved,
+ *     then for each lexeme (24 bytes):
+ *       uint32 lemma, uint32 flags, uint64 POS mask, uint64 values mask
+ * Sentence table: uint64 record offset per sentence
+ * Chunk table, per chunk (24 bytes):
+ *   uint64 first sentence, uint32 sentence count,
+ *   uint32 first attribute, uint32 attribute count, uint32 reserved
+ * Attribute table, per attribute: uint32 name, uint32 value
+ * String table: uint32 offsets[count + 1] into the UTF-8 data that follows
+ * Trailer (72 bytes):
+ *   uint64 offset and count of the sentence, chunk, attribute and string
+ *   tables, char[8] end magic
+ *
+ * Sentence records are in the order written. Sentences written outside of
+ * chunks are not covered by any chunk entry; chunk entries are in the
+ * order written and cover disjoint, ascending ranges of sentences.
+ */
+namespace binformat {
+
+const char magic[8] = {'C', 'O', 'R', 'P', 'U', 'S', '2', 'B'};
+
+const char end_magic[8] = {'C', '2', 'B', 'I', 'N', 'E', 'N', 'D'};
+
+const boost::uint32_t version = 1;
+
+const boost::uint32_t byte_order_mark = 0x01020304;
+
+/// String index denoting a missing string (e.g. no sentence id)
+const boost::uint32_t no_string = 0xffffffff;
+
+/// Lexeme flag: the lexeme is disambiguated
+const boost::uint32_t lexeme_disamb = 1;
+
+const size_t header_size = 24;
+const size_t sentence_header_size = 8;
+const size_t token_header_size = 8;
+const size_t lexeme_size = 24;
+const size_t chunk_entry_size = 24;
+const size_t attribute_size = 8;
+const size_t trailer_size = 72;
+
+/// Checksum of the tagset definition
+boost::uint32_t tagset_checksum(const Tagset& tagset);
+
+/// Mask to integer conversion, independent of the size of unsigned long
+boost::uint64_t mask_to_int(const mask_t& mask);
+
+/// Integer to mask conversion
+mask_t int_to_mask(boost::uint64_t value);
+
+} /* end ns binformat */
+
+} /* end ns Corpus2 */
+
+#endif // LIBCORPUS2_IO_BINFORMAT_H
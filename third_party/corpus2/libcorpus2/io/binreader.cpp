@@ -0,0 +1,329 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE.CORPUS2, LICENSE.POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#include <libcorpus2/io/binreader.h>
+#include <libcorpus2/exception.h>
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <iterator>
+
+namespace Corpus2 {
+
+bool BinReader::registered = TokenReader::register_reader<BinReader>("bin",
+	"disamb_only");
+
+BinReader::BinReader(const Tagset& tagset, std::istream& is)
+	: TokenReader(tagset), data_(NULL), size_(0), disamb_only_(false)
+	, next_sentence_(0), next_chunk_(0)
+{
+	buffer_.assign(std::istreambuf_iterator<char>(is),
+			std::istreambuf_iterator<char>());
+	if (!buffer_.empty()) {
+		data_ = &buffer_[0];
+		size_ = buffer_.size();
+	}
+	open();
+}
+
+BinReader::BinReader(const Tagset& tagset, const std::string& filename)
+	: TokenReader(tagset), data_(NULL), size_(0), disamb_only_(false)
+	, next_sentence_(0), next_chunk_(0)
+{
+	try {
+		file_.open(filename);
+	} catch (std::exception&) {
+		throw FileNotFound(filename, "", "bin reader");
+	}
+	if (!file_.is_open()) {
+		throw FileNotFound(filename, "", "bin reader");
+	}
+	data_ = file_.data();
+	size_ = file_.size();
+	open();
+}
+
+BinReader::~BinReader()
+{
+	BOOST_FOREACH(Token* t, token_buf_) {
+		delete t;
+	}
+}
+
+void BinReader::check_range(boost::uint64_t offset, boost::uint64_t size) const
+{
+	if (offset > size_ || size > size_ - offset) {
+		throw Corpus2Error("Truncated or corrupt bin corpus");
+	}
+}
+
+void BinReader::open()
+{
+	using namespace binformat;
+	if (size_ < header_size + trailer_size
+			|| std::memcmp(data_, magic, sizeof(magic)) != 0) {
+		throw Corpus2Error("Not a bin corpus");
+	}
+	if (get<boost::uint32_t>(12) != byte_order_mark) {
+		throw Corpus2Error("Bin corpus written with another byte order");
+	}
+	if (get<boost::uint32_t>(8) != version) {
+		throw Corpus2Error("Unsupported bin corpus version");
+	}
+	if (get<boost::uint32_t>(16) != tagset_checksum(tagset())) {
+		throw Corpus2Error("Bin corpus written with another tagset than "
+				+ tagset().name());
+	}
+	size_t trailer = size_ - trailer_size;
+	if (std::memcmp(data_ + trailer + 64, end_magic, sizeof(end_magic)) != 0) {
+		throw Corpus2Error("Truncated or corrupt bin corpus");
+	}
+	boost::uint64_t t[8];
+	for (int i = 0; i < 8; ++i) {
+		t[i] = get<boost::uint64_t>(trailer + 8 * i);
+	}
+	check_range(t[0], t[1] * 8);
+	check_range(t[2], t[3] * chunk_entry_size);
+	check_range(t[4], t[5] * attribute_size);
+	check_range(t[6], (t[7] + 1) * 4);
+	sentence_table_ = t[0];
+	sentence_count_ = t[1];
+	chunk_table_ = t[2];
+	chunk_count_ = t[3];
+	attribute_table_ = t[4];
+	attribute_count_ = t[5];
+	string_table_ = t[6];
+	string_count_ = t[7];
+	string_data_ = string_table_ + (string_count_ + 1) * 4;
+	check_range(string_data_,
+			get<boost::uint32_t>(string_table_ + string_count_ * 4));
+	strings_.resize(string_count_);
+	strings_ready_.resize(string_count_, false);
+}
+
+std::string BinReader::utf8_string(boost::uint32_t idx) const
+{
+	if (idx == binformat::no_string) {
+		return "";
+	}
+	if (idx >= string_count_) {
+		throw Corpus2Error("Invalid string index in bin corpus");
+	}
+	boost::uint32_t begin = get<boost::uint32_t>(string_table_ + idx * 4);
+	boost::uint32_t end = get<boost::uint32_t>(string_table_ + idx * 4 + 4);
+	check_range(string_data_ + begin, end - begin);
+	return std::string(data_ + string_data_ + begin, end - begin);
+}
+
+const UnicodeString& BinReader::unicode_string(boost::uint32_t idx)
+{
+	if (idx >= string_count_) {
+		throw Corpus2Error("Invalid string index in bin corpus");
+	}
+	if (!strings_ready_[idx]) {
+		boost::uint32_t begin = get<boost::uint32_t>(string_table_ + idx * 4);
+		boost::uint32_t end = get<boost::uint32_t>(string_table_ + idx * 4 + 4);
+		check_range(string_data_ + begin, end - begin);
+		strings_[idx] = UnicodeString::fromUTF8(StringPiece(
+				data_ + string_data_ + begin, end - begin));
+		strings_ready_[idx] = true;
+	}
+	return strings_[idx];
+}
+
+Sentence::Ptr BinReader::get_sentence(size_t idx)
+{
+	using namespace binformat;
+	if (idx >= sentence_count_) {
+		return Sentence::Ptr();
+	}
+	size_t offset = get<boost::uint64_t>(sentence_table_ + idx * 8);
+	check_range(offset, sentence_header_size);
+	boost::uint32_t tokens = get<boost::uint32_t>(offset);
+	Sentence::Ptr s = make_sentence();
+	s->set_id(utf8_string(get<boost::uint32_t>(offset + 4)));
+	s->tokens().reserve(tokens);
+	offset += sentence_header_size;
+	for (boost::uint32_t i = 0; i < tokens; ++i) {
+		check_range(offset, token_header_size);
+		boost::uint16_t lexemes = get<boost::uint16_t>(offset + 4);
+		boost::uint8_t wa = get<boost::uint8_t>(offset + 6);
+		if (wa >= PwrNlp::Whitespace::PostLast) {
+			throw Corpus2Error("Invalid whitespace in bin corpus");
+		}
+		Token* t = new Token(unicode_string(get<boost::uint32_t>(offset)),
+				static_cast<PwrNlp::Whitespace::Enum>(wa));
+		s->append(t);
+		offset += token_header_size;
+		check_range(offset, lexemes * lexeme_size);
+		t->lexemes().reserve(lexemes);
+		for (boost::uint16_t j = 0; j < lexemes; ++j) {
+			bool disamb = get<boost::uint32_t>(offset + 4) & lexeme_disamb;
+			if (disamb || !disamb_only_) {
+				Tag tag(int_to_mask(get<boost::uint64_t>(offset + 8)),
+						int_to_mask(get<boost::uint64_t>(offset + 16)));
+				t->add_lexeme(Lexeme(
+						unicode_string(get<boost::uint32_t>(offset)), tag));
+				t->lexemes().back().set_disamb(disamb);
+			}
+			offset += lexeme_size;
+		}
+	}
+	return s;
+}
+
+void BinReader::chunk_range(size_t idx, size_t& first, size_t& end) const
+{
+	size_t entry = chunk_table_ + idx * binformat::chunk_entry_size;
+	boost::uint64_t f = get<boost::uint64_t>(entry);
+	boost::uint32_t count = get<boost::uint32_t>(entry + 8);
+	if (f > sentence_count_ || count > sentence_count_ - f) {
+		throw Corpus2Error("Truncated or corrupt bin corpus");
+	}
+	first = f;
+	end = f + count;
+}
+
+boost::shared_ptr<Chunk> BinReader::make_chunk(size_t idx) const
+{
+	size_t entry = chunk_table_ + idx * binformat::chunk_entry_size;
+	boost::uint32_t first_attr = get<boost::uint32_t>(entry + 12);
+	boost::uint32_t attr_count = get<boost::uint32_t>(entry + 16);
+	if (first_attr > attribute_count_
+			|| attr_count > attribute_count_ - first_attr) {
+		throw Corpus2Error("Truncated or corrupt bin corpus");
+	}
+	boost::shared_ptr<Chunk> c = boost::make_shared<Chunk>();
+	for (boost::uint32_t i = 0; i < attr_count; ++i) {
+		size_t attr = attribute_table_
+				+ (first_attr + i) * binformat::attribute_size;
+		c->set_attribute(utf8_string(get<boost::uint32_t>(attr)),
+				utf8_string(get<boost::uint32_t>(attr + 4)));
+	}
+	return c;
+}
+
+boost::shared_ptr<Chunk> BinReader::get_chunk(size_t idx)
+{
+	if (idx >= chunk_count_) {
+		return boost::shared_ptr<Chunk>();
+	}
+	size_t first, end;
+	chunk_range(idx, first, end);
+	boost::shared_ptr<Chunk> c = make_chunk(idx);
+	c->sentences().reserve(end - first);
+	for (size_t i = first; i < end; ++i) {
+		c->append(get_sentence(i));
+	}
+	return c;
+}
+
+Sentence::Ptr BinReader::take_token_buf()
+{
+	if (token_buf_.empty()) {
+		return Sentence::Ptr();
+	}
+	Sentence::Ptr s = boost::make_shared<Sentence>();
+	BOOST_FOREACH(Token* t, token_buf_) {
+		s->append(t);
+	}
+	token_buf_.clear();
+	return s;
+}
+
+Token* BinReader::get_next_token()
+{
+	while (token_buf_.empty()) {
+		Sentence::Ptr s = get_next_sentence();
+		if (!s) {
+			return NULL;
+		}
+		std::copy(s->tokens().begin(), s->tokens().end(),
+				std::back_inserter(token_buf_));
+		s->release_tokens();
+	}
+	Token* t = token_buf_.front();
+	token_buf_.pop_front();
+	return t;
+}
+
+Sentence::Ptr BinReader::get_next_sentence()
+{
+	if (Sentence::Ptr rest = take_token_buf()) {
+		return rest;
+	}
+	if (next_sentence_ >= sentence_count_) {
+		return Sentence::Ptr();
+	}
+	return get_sentence(next_sentence_++);
+}
+
+boost::shared_ptr<Chunk> BinReader::get_next_chunk()
+{
+	// the rest of a sentence partly read by get_next_token comes first
+	Sentence::Ptr rest = take_token_buf();
+	const size_t pos = rest ? next_sentence_ - 1 : next_sentence_;
+	size_t first = 0, end = 0;
+	// skip chunks whose sentences have all been read by get_next_sentence
+	while (next_chunk_ < chunk_count_) {
+		chunk_range(next_chunk_, first, end);
+		if (end > pos || first >= pos) {
+			break;
+		}
+		++next_chunk_;
+	}
+	boost::shared_ptr<Chunk> c;
+	if (next_chunk_ < chunk_count_ && first <= pos) {
+		// the rest of the chunk at the position, with its attributes
+		c = make_chunk(next_chunk_);
+		++next_chunk_;
+	} else {
+		// sentences written outside of chunks (before, between or after
+		// them) are returned in order, each run of them in a chunk of its
+		// own
+		end = next_chunk_ < chunk_count_ ? first : sentence_count_;
+		if (!rest && next_sentence_ >= end) {
+			return boost::shared_ptr<Chunk>();
+		}
+		c = boost::make_shared<Chunk>();
+	}
+	if (rest) {
+		c->append(rest);
+	}
+	while (next_sentence_ < end) {
+		c->append(get_sentence(next_sentence_++));
+	}
+	return c;
+}
+
+void BinReader::set_option(const std::string& option)
+{
+	if (option == "disamb_only") {
+		disamb_only_ = true;
+	} else {
+		TokenReader::set_option(option);
+	}
+}
+
+std::string BinReader::get_option(const std::string& option) const
+{
+	if (option == "disamb_only") {
+		return disamb_only_ ? option : "";
+	}
+	return TokenReader::get_option(option);
+}
+
+} /* end ns Corpus2 */
@@ -0,0 +1,156 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE.CORPUS2, LICENSE.POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#ifndef LIBCORPUS2_IO_BINREADER_H
+#define LIBCORPUS2_IO_BINREADER_H
+
+#include <libcorpus2/io/reader.h>
+#include <libcorpus2/io/binformat.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstring>
+#include <vector>
+
+namespace Corpus2 {
+
+/**
+ * Reader of the compact binary corpus format written by BinWriter, see
+ * binformat.h.
+ *
+ * A file opened by path is memory-mapped, a stream is read into memory
+ * as a whole. Sentences are then built straight from the mapped data with
+ * no parsing, and can also be accessed randomly by index. Each string of
+ * the string table is converted from UTF-8 at most once.
+ *
+ * Reading by chunk keeps the order in which chunks and sentences were
+ * written: sentences written outside of chunks are returned as chunks
+ * (without attributes), one per run of such sentences.
+ *
+ * Unlike with other readers (see TokenReader), sequential reading of
+ * tokens, sentences and chunks may be mixed, as all three share the
+ * position in the file. A sentence partly read by token is finished by
+ * the next get_next_sentence or get_next_chunk call, and a chunk partly
+ * read by sentence is finished by the next get_next_chunk call, which
+ * returns its remaining sentences with its attributes.
+ *
+ * The file must have been written with the same tagset definition,
+ * otherwise construction fails.
+ *
+ * Options:
+ * - disamb_only - only read lexemes marked as disambiguated
+ */
+class BinReader : public TokenReader
+{
+public:
+	BinReader(const Tagset& tagset, std::istream& is);
+
+	BinReader(const Tagset& tagset, const std::string& filename);
+
+	~BinReader();
+
+	Token* get_next_token();
+
+	Sentence::Ptr get_next_sentence();
+
+	boost::shared_ptr<Chunk> get_next_chunk();
+
+	void set_option(const std::string& option);
+
+	std::string get_option(const std::string& option) const;
+
+	/// Number of sentences in the file
+	size_t sentence_count() const {
+		return sentence_count_;
+	}
+
+	/// Number of chunks in the file
+	size_t chunk_count() const {
+		return chunk_count_;
+	}
+
+	/// Random access to a sentence, does not affect sequential reading
+	Sentence::Ptr get_sentence(size_t idx);
+
+	/// Random access to a chunk, does not affect sequential reading
+	boost::shared_ptr<Chunk> get_chunk(size_t idx);
+
+	static bool registered;
+
+private:
+	/// Check the header and trailer and locate the tables
+	void open();
+
+	/// Fail unless the given range lies within the data
+	void check_range(boost::uint64_t offset, boost::uint64_t size) const;
+
+	template <typename T>
+	T get(size_t offset) const {
+		T value;
+		std::memcpy(&value, data_ + offset, sizeof(T));
+		return value;
+	}
+
+	std::string utf8_string(boost::uint32_t idx) const;
+
+	const UnicodeString& unicode_string(boost::uint32_t idx);
+
+	/// Get the range of sentence indices of a chunk, checking it
+	void chunk_range(size_t idx, size_t& first, size_t& end) const;
+
+	/// Create a chunk with the attributes of the given one and no sentences
+	boost::shared_ptr<Chunk> make_chunk(size_t idx) const;
+
+	/// The tokens left from a sentence read by token, as a sentence, or
+	/// NULL if there are none
+	Sentence::Ptr take_token_buf();
+
+	boost::iostreams::mapped_file_source file_;
+
+	/// Contents of a stream, unused when the file is mapped
+	std::vector<char> buffer_;
+
+	const char* data_;
+
+	size_t size_;
+
+	size_t sentence_table_;
+	size_t sentence_count_;
+	size_t chunk_table_;
+	size_t chunk_count_;
+	size_t attribute_table_;
+	size_t attribute_count_;
+	size_t string_table_;
+	size_t string_count_;
+
+	/// Start of the UTF-8 string data
+	size_t string_data_;
+
+	/// Strings already converted from UTF-8
+	std::vector<UnicodeString> strings_;
+	std::vector<bool> strings_ready_;
+
+	bool disamb_only_;
+
+	size_t next_sentence_;
+
+	size_t next_chunk_;
+
+	std::deque<Token*> token_buf_;
+};
+
+} /* end ns Corpus2 */
+
+#endif // LIBCORPUS2_IO_BINREADER_H
@@ -0,0 +1,181 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE.CORPUS2, LICENSE.POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#include <libcorpus2/io/binwriter.h>
+#include <libcorpus2/exception.h>
+#include <boost/foreach.hpp>
+#include <limits>
+
+namespace Corpus2 {
+
+bool BinWriter::registered = TokenWriter::register_writer<BinWriter>("bin",
+		"");
+
+BinWriter::BinWriter(std::ostream& os, const Tagset& tagset,
+		const string_range_vector& params)
+	: TokenWriter(os, tagset, params), offset_(0)
+{
+	os.write(binformat::magic, sizeof(binformat::magic));
+	offset_ += sizeof(binformat::magic);
+	put(binformat::version);
+	put(binformat::byte_order_mark);
+	put(binformat::tagset_checksum(tagset));
+	put(boost::uint32_t(0));
+}
+
+BinWriter::~BinWriter()
+{
+	finish();
+	BOOST_FOREACH(Token* t, pending_.tokens()) {
+		delete t;
+	}
+	pending_.release_tokens();
+}
+
+void BinWriter::write_token(const Token& t)
+{
+	pending_.append(t.clone());
+}
+
+void BinWriter::write_sentence(const Sentence& s)
+{
+	flush_tokens();
+	write_sentence_record(s);
+}
+
+void BinWriter::write_chunk(const Chunk& c)
+{
+	flush_tokens();
+	ChunkEntry entry;
+	entry.first_sentence = sentence_offsets_.size();
+	entry.sentence_count = c.size();
+	entry.first_attribute = attributes_.size();
+	entry.attribute_count = c.attributes().size();
+	typedef std::pair<std::string, std::string> attr_t;
+	BOOST_FOREACH(const attr_t& a, c.attributes()) {
+		attributes_.push_back(std::make_pair(
+				string_index(a.first), string_index(a.second)));
+	}
+	chunks_.push_back(entry);
+	BOOST_FOREACH(const Sentence::ConstPtr& s, c.sentences()) {
+		write_sentence_record(*s);
+	}
+}
+
+void BinWriter::flush_tokens()
+{
+	if (pending_.empty()) return;
+	write_sentence_record(pending_);
+	BOOST_FOREACH(Token* t, pending_.tokens()) {
+		delete t;
+	}
+	pending_.release_tokens();
+}
+
+void BinWriter::write_sentence_record(const Sentence& s)
+{
+	sentence_offsets_.push_back(offset_);
+	put(boost::uint32_t(s.size()));
+	if (s.id().empty()) {
+		put(binformat::no_string);
+	} else {
+		put(string_index(s.id()));
+	}
+	BOOST_FOREACH(const Token* t, s.tokens()) {
+		if (t->lexemes().size() > std::numeric_limits<boost::uint16_t>::max()) {
+			throw Corpus2Error("Too many lexemes for the bin format: "
+					+ t->orth_utf8());
+		}
+		utf8_buf_.clear();
+		t->orth().toUTF8String(utf8_buf_);
+		put(string_index(utf8_buf_));
+		put(boost::uint16_t(t->lexemes().size()));
+		put(boost::uint8_t(t->wa()));
+		put(boost::uint8_t(0));
+		BOOST_FOREACH(const Lexeme& lex, t->lexemes()) {
+			utf8_buf_.clear();
+			lex.lemma().toUTF8String(utf8_buf_);
+			put(string_index(utf8_buf_));
+			put(lex.is_disamb() ? binformat::lexeme_disamb : boost::uint32_t(0));
+			put(binformat::mask_to_int(lex.tag().get_pos()));
+			put(binformat::mask_to_int(lex.tag().get_values()));
+		}
+	}
+}
+
+boost::uint32_t BinWriter::string_index(const std::string& s)
+{
+	std::map<std::string, boost::uint32_t>::iterator i;
+	i = string_ids_.lower_bound(s);
+	if (i != string_ids_.end() && i->first == s) {
+		return i->second;
+	}
+	boost::uint32_t idx = strings_.size();
+	string_ids_.insert(i, std::make_pair(s, idx));
+	strings_.push_back(s);
+	return idx;
+}
+
+void BinWriter::do_footer()
+{
+	flush_tokens();
+
+	boost::uint64_t sentence_table = offset_;
+	BOOST_FOREACH(boost::uint64_t o, sentence_offsets_) {
+		put(o);
+	}
+
+	boost::uint64_t chunk_table = offset_;
+	BOOST_FOREACH(const ChunkEntry& c, chunks_) {
+		put(c.first_sentence);
+		put(c.sentence_count);
+		put(c.first_attribute);
+		put(c.attribute_count);
+		put(boost::uint32_t(0));
+	}
+
+	boost::uint64_t attribute_table = offset_;
+	typedef std::pair<boost::uint32_t, boost::uint32_t> attr_t;
+	BOOST_FOREACH(const attr_t& a, attributes_) {
+		put(a.first);
+		put(a.second);
+	}
+
+	boost::uint64_t string_table = offset_;
+	boost::uint32_t data_offset = 0;
+	BOOST_FOREACH(const std::string& s, strings_) {
+		put(data_offset);
+		data_offset += s.size();
+	}
+	put(data_offset);
+	BOOST_FOREACH(const std::string& s, strings_) {
+		os().write(s.data(), s.size());
+		offset_ += s.size();
+	}
+
+	put(sentence_table);
+	put(boost::uint64_t(sentence_offsets_.size()));
+	put(chunk_table);
+	put(boost::uint64_t(chunks_.size()));
+	put(attribute_table);
+	put(boost::uint64_t(attributes_.size()));
+	put(string_table);
+	put(boost::uint64_t(strings_.size()));
+	os().write(binformat::end_magic, sizeof(binformat::end_magic));
+	os().flush();
+}
+
+} /* end ns Corpus2 */
@@ -0,0 +1,105 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE.CORPUS2, LICENSE.POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#ifndef LIBCORPUS2_IO_BINWRITER_H
+#define LIBCORPUS2_IO_BINWRITER_H
+
+#include <libcorpus2/io/writer.h>
+#include <libcorpus2/io/binformat.h>
+
+#include <map>
+#include <vector>
+
+namespace Corpus2 {
+
+/**
+ * Writer of the compact binary corpus format, see binformat.h. The output
+ * can be read back by BinReader with the same tagset.
+ *
+ * Sentences are written as they arrive, the string table and the index
+ * tables are kept in memory and written in the footer, so the output is
+ * only valid after finish() or destruction of the writer. Tokens written
+ * with write_token are gathered into one sentence that is written before
+ * the next sentence or chunk.
+ *
+ * Sentence annotation channels are not stored.
+ */
+class BinWriter : public TokenWriter
+{
+public:
+	BinWriter(std::ostream& os, const Tagset& tagset,
+			const string_range_vector& params);
+
+	~BinWriter();
+
+	void write_token(const Token& t);
+
+	void write_sentence(const Sentence& s);
+
+	void write_chunk(const Chunk& c);
+
+	static bool registered;
+
+protected:
+	void do_footer();
+
+private:
+	struct ChunkEntry
+	{
+		boost::uint64_t first_sentence;
+		boost::uint32_t sentence_count;
+		boost::uint32_t first_attribute;
+		boost::uint32_t attribute_count;
+	};
+
+	/// Write the tokens gathered by write_token as a sentence, if any
+	void flush_tokens();
+
+	void write_sentence_record(const Sentence& s);
+
+	/// Index of a string in the string table, adding it if needed
+	boost::uint32_t string_index(const std::string& s);
+
+	template <typename T>
+	void put(T value) {
+		os().write(reinterpret_cast<const char*>(&value), sizeof(T));
+		offset_ += sizeof(T);
+	}
+
+	/// Number of bytes written so far
+	boost::uint64_t offset_;
+
+	std::map<std::string, boost::uint32_t> string_ids_;
+
+	std::vector<std::string> strings_;
+
+	std::vector<boost::uint64_t> sentence_offsets_;
+
+	std::vector<ChunkEntry> chunks_;
+
+	/// Chunk attributes as pairs of string indices
+	std::vector< std::pair<boost::uint32_t, boost::uint32_t> > attributes_;
+
+	/// Tokens written with write_token, not yet in any sentence
+	Sentence pending_;
+
+	/// Buffer for UTF-8 conversion of orths and lemmas
+	std::string utf8_buf_;
+};
+
+} /* end ns Corpus2 */
+
+#endif // LIBCORPUS2_IO_BINWRITER_H
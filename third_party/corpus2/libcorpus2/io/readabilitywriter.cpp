@@ -0,0 +1,299 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE.CORPUS2, LICENSE.POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#include <libcorpus2/io/readabilitywriter.h>
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+#include <unicode/uchar.h>
+#include <cstdio>
+
+namespace Corpus2 {
+
+bool ReadabilityWriter::registered =
+		TokenWriter::register_writer<ReadabilityWriter>("readability",
+		"nochunks");
+
+const int ReadabilityWriter::hard_word_syllables = 4;
+
+const int ReadabilityWriter::lix_word_length = 8;
+
+const size_t ReadabilityWriter::long_sentence_tokens = 20;
+
+namespace {
+
+	/// Write a string as a quoted JSON string
+	void write_json_string(std::ostream& os, const std::string& s)
+	{
+		os << '"';
+		BOOST_FOREACH(char c, s) {
+			switch (c) {
+			case '"':
+				os << "\\\"";
+				break;
+			case '\\':
+				os << "\\\\";
+				break;
+			case '\n':
+				os << "\\n";
+				break;
+			case '\t':
+				os << "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char buf[8];
+					sprintf(buf, "\\u%04x", static_cast<unsigned char>(c));
+					os << buf;
+				} else {
+					os << c;
+				}
+			}
+		}
+		os << '"';
+	}
+
+	/// Increment the count of a value in a distribution
+	void count_value(std::vector<size_t>& h, int value)
+	{
+		if (value < 0) return;
+		if (h.size() <= static_cast<size_t>(value)) {
+			h.resize(value + 1, 0);
+		}
+		++h[value];
+	}
+
+	/// Grammatical classes that are not words (NKJP/IPI class names)
+	bool is_punctuation(const std::string& pos)
+	{
+		return pos == "interp";
+	}
+
+	/// Grammatical classes skipped in Pisarek counts besides punctuation
+	bool is_numeral(const std::string& pos)
+	{
+		return pos == "num" || pos == "numcol";
+	}
+
+} /* end anon ns */
+
+ReadabilityWriter::Counts::Counts()
+	: sentences(0), long_sentences(0), tokens(0), words(0)
+	, fog_orth(0), fog_base(0), pisarek_orth(0), pisarek_base(0), lix(0)
+{
+}
+
+void ReadabilityWriter::Counts::add(const Counts& other)
+{
+	sentences += other.sentences;
+	long_sentences += other.long_sentences;
+	tokens += other.tokens;
+	words += other.words;
+	fog_orth += other.fog_orth;
+	fog_base += other.fog_base;
+	pisarek_orth += other.pisarek_orth;
+	pisarek_base += other.pisarek_base;
+	lix += other.lix;
+}
+
+ReadabilityWriter::ReadabilityWriter(std::ostream& os, const Tagset& tagset,
+		const string_range_vector& params)
+	: TokenWriter(os, tagset, params)
+	, syllabifier_(boost::make_shared<PolishSyllabifier>())
+	, write_chunks_(true), chunks_started_(false), chunk_count_(0)
+	, paragraphs_(0)
+{
+	BOOST_FOREACH(const string_range& param, params) {
+		std::string p = boost::copy_range<std::string>(param);
+		if (p == "nochunks") {
+			write_chunks_ = false;
+		}
+	}
+}
+
+ReadabilityWriter::~ReadabilityWriter()
+{
+	finish();
+}
+
+void ReadabilityWriter::count_token(const Token& t, size_t pos,
+		Counts& counts)
+{
+	++counts.tokens;
+	const UnicodeString& orth = t.orth();
+	UnicodeString base = orth;
+	std::string pos_name;
+	if (!t.lexemes().empty()) {
+		const Lexeme& lex = t.get_preferred_lexeme(tagset());
+		base = lex.lemma();
+		int pos_idx = lex.tag().get_pos_index();
+		if (pos_idx >= 0) {
+			pos_name = tagset().get_pos_name(pos_idx);
+		}
+	}
+
+	const int orth_length = orth.countChar32();
+	if (orth_length > lix_word_length) {
+		++counts.lix;
+		hard_words_.insert(PwrNlp::to_utf8(orth));
+	}
+	if (is_punctuation(pos_name)) {
+		return;
+	}
+
+	++counts.words;
+	++classes_[pos_name];
+	const int orth_syllables = syllabifier_->count_syllables(orth);
+	const int base_syllables = syllabifier_->count_syllables(base);
+	count_value(orth_length_, orth_length);
+	count_value(base_length_, base.countChar32());
+	count_value(orth_syllables_, orth_syllables);
+	count_value(base_syllables_, base_syllables);
+
+	const bool orth_hard = orth_syllables >= hard_word_syllables;
+	const bool base_hard = base_syllables >= hard_word_syllables;
+	if (orth_hard) {
+		++counts.fog_orth;
+		hard_words_.insert(PwrNlp::to_utf8(orth));
+	}
+	if (base_hard) {
+		++counts.fog_base;
+	}
+
+	const bool proper_name = pos > 0 && orth.length() > 0
+			&& u_isupper(orth.char32At(0));
+	if (!is_numeral(pos_name) && !proper_name) {
+		if (orth_hard) {
+			++counts.pisarek_orth;
+		}
+		if (base_hard) {
+			++counts.pisarek_base;
+		}
+	}
+}
+
+void ReadabilityWriter::count_sentence(const Sentence& s, Counts& counts)
+{
+	++counts.sentences;
+	if (s.size() > long_sentence_tokens) {
+		++counts.long_sentences;
+	}
+	for (size_t i = 0; i < s.size(); ++i) {
+		count_token(*s[i], i, counts);
+	}
+}
+
+void ReadabilityWriter::write_token(const Token& t)
+{
+	count_token(t, 0, totals_);
+}
+
+void ReadabilityWriter::write_sentence(const Sentence& s)
+{
+	count_sentence(s, totals_);
+}
+
+void ReadabilityWriter::write_chunk(const Chunk& c)
+{
+	Counts counts;
+	BOOST_FOREACH(const Sentence::Ptr& s, c.sentences()) {
+		count_sentence(*s, counts);
+	}
+	if (!c.sentences().empty()) {
+		++paragraphs_;
+	}
+	totals_.add(counts);
+
+	if (write_chunks_) {
+		os() << (chunks_started_ ? "," : "{\"chunks\":[");
+		chunks_started_ = true;
+		os() << "{\"id\":";
+		if (c.has_attribute("id")) {
+			write_json_string(os(), c.get_attribute("id"));
+		} else {
+			os() << "\"ch" << (chunk_count_ + 1) << "\"";
+		}
+		os() << ",";
+		write_counts(counts);
+		os() << "}";
+	}
+	++chunk_count_;
+}
+
+void ReadabilityWriter::write_counts(const Counts& counts)
+{
+	os() << "\"sentences\":" << counts.sentences
+		<< ",\"long_sentences\":" << counts.long_sentences
+		<< ",\"tokens\":" << counts.tokens
+		<< ",\"words\":" << counts.words
+		<< ",\"hard_words\":{"
+		<< "\"fog_orth\":" << counts.fog_orth
+		<< ",\"fog_base\":" << counts.fog_base
+		<< ",\"pisarek_orth\":" << counts.pisarek_orth
+		<< ",\"pisarek_base\":" << counts.pisarek_base
+		<< ",\"lix\":" << counts.lix
+		<< "}";
+}
+
+void ReadabilityWriter::write_histogram(const char* name,
+		const std::vector<size_t>& h)
+{
+	os() << ",\"" << name << "\":[";
+	for (size_t i = 0; i < h.size(); ++i) {
+		if (i > 0) os() << ",";
+		os() << h[i];
+	}
+	os() << "]";
+}
+
+void ReadabilityWriter::do_footer()
+{
+	if (write_chunks_) {
+		os() << (chunks_started_ ? "]," : "{\"chunks\":[],");
+	} else {
+		os() << "{";
+	}
+	os() << "\"document\":{\"paragraphs\":" << paragraphs_ << ",";
+	write_counts(totals_);
+
+	os() << ",\"classes\":{";
+	bool first = true;
+	typedef std::map<std::string, size_t>::value_type class_count_t;
+	BOOST_FOREACH(const class_count_t& cc, classes_) {
+		if (!first) os() << ",";
+		first = false;
+		write_json_string(os(), cc.first);
+		os() << ":" << cc.second;
+	}
+	os() << "}";
+
+	write_histogram("orth_length", orth_length_);
+	write_histogram("base_length", base_length_);
+	write_histogram("orth_syllables", orth_syllables_);
+	write_histogram("base_syllables", base_syllables_);
+
+	os() << ",\"hard_word_count\":" << hard_words_.size()
+		<< ",\"hard_word_forms\":[";
+	first = true;
+	BOOST_FOREACH(const std::string& w, hard_words_) {
+		if (!first) os() << ",";
+		first = false;
+		write_json_string(os(), w);
+	}
+	os() << "]}}\n";
+	needs_footer_ = false;
+}
+
+} /* end ns Corpus2 */
@@ -0,0 +1,151 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE.CORPUS2, LICENSE.POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#ifndef LIBCORPUS2_IO_READABILITYWRITER_H
+#define LIBCORPUS2_IO_READABILITYWRITER_H
+
+#include <libcorpus2/io/writer.h>
+#include <libcorpus2/util/syllabifier.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace Corpus2 {
+
+/**
+ * Writer that outputs readability statistics of the text instead of the
+ * text itself, as compact JSON.
+ *
+ * Statistics are gathered while tokens stream through, so memory use does
+ * not depend on the size of the input (apart from the set of distinct hard
+ * words). Each chunk (paragraph) is written as soon as it arrives with its
+ * own counts, and the document totals, distributions and hard words are
+ * written in the footer:
+ *
+ * {"chunks":[{...},...],"document":{...}}
+ *
+ * Words are tokens other than punctuation. A word is hard if it has at
+ * least four syllables; for the Pisarek counts numerals and proper names
+ * (capitalised words not opening the sentence) are skipped. Any token
+ * longer than eight characters, punctuation included, counts as long in
+ * LIX. The hard word forms listed in the footer (hard_word_forms and
+ * hard_word_count) are the distinct orths of hard words and of these
+ * long tokens.
+ *
+ * Punctuation and numerals are recognised by the grammatical class names
+ * interp, num and numcol, so the statistics assume an NKJP or IPI style
+ * tagset (e.g. nkjp, ikipi or kipi); with other tagsets all tokens count
+ * as words and no numerals are skipped.
+ *
+ * Options:
+ * - nochunks - only write the document statistics
+ */
+class ReadabilityWriter : public TokenWriter
+{
+public:
+	ReadabilityWriter(std::ostream& os, const Tagset& tagset,
+			const string_range_vector& params);
+
+	~ReadabilityWriter();
+
+	void write_token(const Token& t);
+
+	void write_sentence(const Sentence& s);
+
+	void write_chunk(const Chunk& c);
+
+	/// Use another syllabifier for hard word detection
+	void set_syllabifier(const boost::shared_ptr<const Syllabifier>& s) {
+		syllabifier_ = s;
+	}
+
+	/// Minimum number of syllables of a hard word
+	static const int hard_word_syllables;
+
+	/// Words longer than this count as long in LIX
+	static const int lix_word_length;
+
+	/// Sentences with more tokens than this are long
+	static const size_t long_sentence_tokens;
+
+	static bool registered;
+
+protected:
+	void do_footer();
+
+private:
+	/// Counts gathered for a chunk and for the whole document
+	struct Counts
+	{
+		Counts();
+
+		void add(const Counts& other);
+
+		size_t sentences;
+		size_t long_sentences;
+		size_t tokens;
+		size_t words;
+		size_t fog_orth;
+		size_t fog_base;
+		size_t pisarek_orth;
+		size_t pisarek_base;
+		size_t lix;
+	};
+
+	/// Update counts with a token at the given position in its sentence
+	void count_token(const Token& t, size_t pos, Counts& counts);
+
+	/// Update counts with a sentence
+	void count_sentence(const Sentence& s, Counts& counts);
+
+	/// Write counts as JSON members (without braces)
+	void write_counts(const Counts& counts);
+
+	/// Write a distribution as a JSON array indexed by value
+	void write_histogram(const char* name, const std::vector<size_t>& h);
+
+	boost::shared_ptr<const Syllabifier> syllabifier_;
+
+	bool write_chunks_;
+
+	/// Whether the chunks array has been opened
+	bool chunks_started_;
+
+	size_t chunk_count_;
+
+	size_t paragraphs_;
+
+	Counts totals_;
+
+	/// Number of words per grammatical class
+	std::map<std::string, size_t> classes_;
+
+	/// Distributions of orth and base length and syllables over words
+	std::vector<size_t> orth_length_;
+	std::vector<size_t> base_length_;
+	std::vector<size_t> orth_syllables_;
+	std::vector<size_t> base_syllables_;
+
+	/// Distinct orths of hard words and of tokens long in LIX (in UTF-8)
+	std::set<std::string> hard_words_;
+};
+
+} /* end ns Corpus2 */
+
+#endif // LIBCORPUS2_IO_READABILITYWRITER_H
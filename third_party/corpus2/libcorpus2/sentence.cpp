@@ -34,6 +34,7 @@ Sentence::~Sentence()
 Sentence::Ptr Sentence::clone_shared() const
 {
 	Sentence::Ptr s = boost::make_shared<Sentence>(id_);
+	s->tokens_.reserve(tokens_.size());
 	BOOST_FOREACH(const Token* t, tokens_) {
 		s->append(t->clone());
 	}
@@ -843,6 +843,8 @@ void Tagset::lexemes_into_token(Token& tok, const UnicodeString& lemma,
 {
 	string_range_vector options;
 	boost::algorithm::split(options, tags, boost::is_any_of("+|"));
+	// each option gives at least one lexeme, more if it has wildcards
+	tok.lexemes().reserve(tok.lexemes().size() + options.size());
 
 	boost::function<Lexeme (const Tag&)> lex;
 	lex = boost::bind(&Lexeme::create, boost::cref(lemma), _1);
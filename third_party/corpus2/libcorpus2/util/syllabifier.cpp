@@ -0,0 +1,52 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE.CORPUS2, LICENSE.POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#include <libcorpus2/util/syllabifier.h>
+#include <unicode/uchar.h>
+
+namespace Corpus2 {
+
+bool PolishSyllabifier::is_vowel(UChar32 c)
+{
+	switch (c) {
+	case 'a': case 'e': case 'i': case 'o': case 'u': case 'y':
+	case 0x0105: // ą
+	case 0x0119: // ę
+	case 0x00F3: // ó
+		return true;
+	default:
+		return false;
+	}
+}
+
+int PolishSyllabifier::count_syllables(const UnicodeString& word) const
+{
+	int syllables = 0;
+	UChar32 prev = 0;
+	for (int32_t i = 0; i < word.length(); i = word.moveIndex32(i, 1)) {
+		UChar32 c = u_tolower(word.char32At(i));
+		if (is_vowel(c)) {
+			// "i" before a vowel is not a syllable of its own
+			if (!(prev == 'i' && c != 'i')) {
+				++syllables;
+			}
+		}
+		prev = c;
+	}
+	return syllables;
+}
+
+} /* end ns Corpus2 */
@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. 
+
+    See the LICENSE.CORPUS2, LICENSE.POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#ifndef LIBCORPUS2_UTIL_SYLLABIFIER_H
+#define LIBCORPUS2_UTIL_SYLLABIFIER_H
+
+#include <unicode/unistr.h>
+
+namespace Corpus2 {
+
+/**
+ * Base class for syllable counters used e.g. in readability statistics.
+ */
+class Syllabifier
+{
+public:
+	virtual ~Syllabifier() {}
+
+	/// Return the number of syllables in the given word
+	virtual int count_syllables(const UnicodeString& word) const = 0;
+};
+
+/**
+ * Syllable counter for Polish based on vowel letters.
+ *
+ * Each vowel letter (a, ą, e, ę, i, o, ó, u, y) is a syllable nucleus,
+ * except for an "i" followed by another vowel, which only marks softening
+ * of the preceding consonant (as in "nie", "się", "ziemia"). Words with no
+ * vowels (e.g. "w", "z", numbers) have zero syllables.
+ */
+class PolishSyllabifier : public Syllabifier
+{
+public:
+	int count_syllables(const UnicodeString& word) const;
+
+	/// Check if the character is a Polish vowel letter (lowercase)
+	static bool is_vowel(UChar32 c);
+};
+
+} /* end ns Corpus2 */
+
+#endif // LIBCORPUS2_UTIL_SYLLABIFIER_H
@@ -0,0 +1,211 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the LICENCE, COPYING.LESSER and COPYING files for more details.
+*/
+
+#include <libpwrutils/stagetimer.h>
+
+#include <boost/foreach.hpp>
+
+#include <iomanip>
+#include <ostream>
+
+#ifdef __unix__
+#include <sys/resource.h>
+#include <time.h>
+#else
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#endif
+
+namespace PwrNlp {
+
+boost::uint64_t monotonic_microseconds()
+{
+#ifdef __unix__
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<boost::uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#else
+	static const boost::posix_time::ptime epoch(
+			boost::posix_time::microsec_clock::universal_time());
+	return (boost::posix_time::microsec_clock::universal_time() - epoch)
+			.total_microseconds();
+#endif
+}
+
+size_t peak_memory_kb()
+{
+#ifdef __unix__
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+#endif
+	return 0;
+}
+
+StageStats::StageStats()
+{
+	clear();
+}
+
+void StageStats::clear()
+{
+	calls = tokens = total_us = max_us = 0;
+	for (int i = 0; i < histogram_size; ++i) {
+		histogram[i] = 0;
+	}
+}
+
+void StageStats::merge(const StageStats& other)
+{
+	calls += other.calls;
+	tokens += other.tokens;
+	total_us += other.total_us;
+	if (other.max_us > max_us) max_us = other.max_us;
+	for (int i = 0; i < histogram_size; ++i) {
+		histogram[i] += other.histogram[i];
+	}
+}
+
+double StageStats::tokens_per_second() const
+{
+	if (total_us == 0) return 0;
+	return tokens * 1e6 / total_us;
+}
+
+boost::uint64_t StageStats::latency_quantile(double q) const
+{
+	boost::uint64_t wanted = static_cast<boost::uint64_t>(q * calls);
+	if (wanted >= calls && calls > 0) wanted = calls - 1;
+	boost::uint64_t seen = 0;
+	for (int i = 0; i < histogram_size; ++i) {
+		seen += histogram[i];
+		if (seen > wanted) {
+			boost::uint64_t bound = static_cast<boost::uint64_t>(1) << i;
+			return bound < max_us ? bound : max_us;
+		}
+	}
+	return max_us;
+}
+
+StageStats& StageProfile::stage(const std::string& name)
+{
+	std::map<std::string, StageStats>::iterator i = stages_.find(name);
+	if (i == stages_.end()) {
+		names_.push_back(name);
+		i = stages_.insert(std::make_pair(name, StageStats())).first;
+	}
+	return i->second;
+}
+
+const StageStats* StageProfile::find(const std::string& name) const
+{
+	std::map<std::string, StageStats>::const_iterator i = stages_.find(name);
+	if (i == stages_.end()) return NULL;
+	return &i->second;
+}
+
+void StageProfile::clear()
+{
+	typedef std::map<std::string, StageStats>::value_type entry_t;
+	BOOST_FOREACH (entry_t& e, stages_) {
+		e.second.clear();
+	}
+}
+
+void StageProfile::merge(const StageProfile& other)
+{
+	BOOST_FOREACH (const std::string& name, other.names_) {
+		stage(name).merge(*other.find(name));
+	}
+}
+
+void StageProfile::dump(std::ostream& os) const
+{
+	os << std::left << std::setw(24) << "Stage"
+		<< std::right << std::setw(10) << "calls"
+		<< std::setw(12) << "tokens"
+		<< std::setw(12) << "total ms"
+		<< std::setw(10) << "p50 us"
+		<< std::setw(10) << "p99 us"
+		<< std::setw(10) << "max us"
+		<< std::setw(12) << "tokens/s" << "\n";
+	BOOST_FOREACH (const std::string& name, names_) {
+		const StageStats& s = *find(name);
+		if (s.calls == 0) continue;
+		os << std::left << std::setw(24) << name
+			<< std::right << std::setw(10) << s.calls
+			<< std::setw(12) << s.tokens
+			<< std::setw(12) << s.total_us / 1000
+			<< std::setw(10) << s.latency_quantile(0.5)
+			<< std::setw(10) << s.latency_quantile(0.99)
+			<< std::setw(10) << s.max_us
+			<< std::setw(12) << static_cast<boost::uint64_t>(s.tokens_per_second())
+			<< "\n";
+	}
+}
+
+namespace {
+
+void write_json_string(std::ostream& os, const std::string& s)
+{
+	os << '"';
+	BOOST_FOREACH (char c, s) {
+		if (c == '"' || c == '\\') {
+			os << '\\' << c;
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+				<< static_cast<int>(c) << std::dec << std::setfill(' ');
+		} else {
+			os << c;
+		}
+	}
+	os << '"';
+}
+
+} /* end anon ns */
+
+void StageProfile::write_json(std::ostream& os) const
+{
+	os << "{";
+	bool first = true;
+	BOOST_FOREACH (const std::string& name, names_) {
+		const StageStats& s = *find(name);
+		if (!first) os << ",";
+		first = false;
+		write_json_string(os, name);
+		os << ":{\"calls\":" << s.calls
+			<< ",\"tokens\":" << s.tokens
+			<< ",\"total_us\":" << s.total_us
+			<< ",\"max_us\":" << s.max_us
+			<< ",\"p50_us\":" << s.latency_quantile(0.5)
+			<< ",\"p99_us\":" << s.latency_quantile(0.99)
+			<< ",\"tokens_per_s\":" << static_cast<boost::uint64_t>(s.tokens_per_second())
+			<< ",\"histogram\":[";
+		int used = StageStats::histogram_size;
+		while (used > 0 && s.histogram[used - 1] == 0) --used;
+		for (int i = 0; i < used; ++i) {
+			if (i > 0) os << ",";
+			os << s.histogram[i];
+		}
+		os << "]}";
+	}
+	os << "}";
+}
+
+} /* end ns PwrNlp */
@@ -0,0 +1,171 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the LICENCE, COPYING.LESSER and COPYING files for more details.
+*/
+
+#ifndef PWRNLP_STAGETIMER_H
+#define PWRNLP_STAGETIMER_H
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+namespace PwrNlp {
+
+/// Current time of a monotonic clock in microseconds.
+boost::uint64_t monotonic_microseconds();
+
+/**
+ * Timing and counts of one processing stage (e.g. tokenization or a tagger
+ * layer). Each timed run of the stage adds its wall time and the number of
+ * tokens processed, and is counted in a latency histogram whose bucket
+ * i holds runs that took less than 2^i microseconds (and at least 2^(i-1)).
+ */
+class StageStats
+{
+public:
+	static const int histogram_size = 32;
+
+	StageStats();
+
+	/// Add one run of the stage.
+	void add(boost::uint64_t microseconds, size_t tokens) {
+		++calls;
+		this->tokens += tokens;
+		total_us += microseconds;
+		if (microseconds > max_us) max_us = microseconds;
+		int bucket = 0;
+		while (microseconds > 0 && bucket < histogram_size - 1) {
+			microseconds >>= 1;
+			++bucket;
+		}
+		++histogram[bucket];
+	}
+
+	/// Set all counts to 0.
+	void clear();
+
+	/// Add the counts of other.
+	void merge(const StageStats& other);
+
+	/// Tokens per second of wall time spent in the stage, 0 if none spent.
+	double tokens_per_second() const;
+
+	/// Upper bound of the latency (in microseconds) below which the
+	/// fraction q of the runs fall, read from the histogram.
+	boost::uint64_t latency_quantile(double q) const;
+
+	boost::uint64_t calls;
+	boost::uint64_t tokens;
+	boost::uint64_t total_us;
+	boost::uint64_t max_us;
+	boost::uint64_t histogram[histogram_size];
+};
+
+/**
+ * Named stage statistics of a processing pipeline, kept in the order in
+ * which the stages were first used. A profile is not synchronized: each
+ * thread should time its stages into its own profile and the profiles
+ * should be merged afterwards.
+ */
+class StageProfile
+{
+public:
+	/**
+	 * Statistics of the named stage, created empty on first use. The
+	 * returned reference stays valid for the lifetime of the profile,
+	 * also across clear(), so it may be kept by hot code to avoid lookups.
+	 */
+	StageStats& stage(const std::string& name);
+
+	/// The stage names in order of first use.
+	const std::vector<std::string>& stage_names() const {
+		return names_;
+	}
+
+	/// Statistics of the named stage, or NULL if it was never used.
+	const StageStats* find(const std::string& name) const;
+
+	/// Set counts of all stages to 0 (the stages are kept).
+	void clear();
+
+	/// Add the counts of other, stage by stage.
+	void merge(const StageProfile& other);
+
+	/// Print a table with a line per stage.
+	void dump(std::ostream& os) const;
+
+	/**
+	 * Write the stages as a JSON object mapping stage name to an object
+	 * with calls, tokens, total_us, max_us, p50_us, p99_us, tokens_per_s
+	 * and histogram (counts of the non-empty tail trimmed).
+	 */
+	void write_json(std::ostream& os) const;
+
+private:
+	std::map<std::string, StageStats> stages_;
+	std::vector<std::string> names_;
+};
+
+/**
+ * Scoped timer adding the time from its construction to its destruction
+ * to a stage. A timer created with a NULL stage does nothing, which lets
+ * optional profiling cost a single branch.
+ */
+class StageTimer
+{
+public:
+	explicit StageTimer(StageStats* stats, size_t tokens = 0)
+		: stats_(stats), tokens_(tokens)
+		, start_(stats ? monotonic_microseconds() : 0)
+	{
+	}
+
+	~StageTimer() {
+		stop();
+	}
+
+	/// Set the number of tokens to report, if not known at construction.
+	void set_tokens(size_t tokens) {
+		tokens_ = tokens;
+	}
+
+	/// Add the elapsed time now rather than on destruction.
+	void stop() {
+		if (stats_) {
+			stats_->add(monotonic_microseconds() - start_, tokens_);
+			stats_ = 0;
+		}
+	}
+
+private:
+	StageTimer(const StageTimer&);
+	StageTimer& operator=(const StageTimer&);
+
+	StageStats* stats_;
+	size_t tokens_;
+	boost::uint64_t start_;
+};
+
+/**
+ * Peak resident set size of the process in kilobytes, or 0 if it can
+ * not be determined on this platform.
+ */
+size_t peak_memory_kb();
+
+} /* end ns PwrNlp */
+
+#endif // PWRNLP_STAGETIMER_H
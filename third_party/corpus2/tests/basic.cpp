@@ -16,6 +16,7 @@ or FITNESS FOR A PARTICULAR PURPOSE.
 
 #include <boost/test/unit_test.hpp>
 
+#include <libcorpus2/sentence.h>
 #include <libcorpus2/token.h>
 
 const char tagsetstr1[] = "[ATTR]\n"
@@ -59,6 +60,27 @@ BOOST_AUTO_TEST_CASE( token_dup_lexemes )
 	delete tt;
 }
 
+BOOST_AUTO_TEST_CASE( sentence_clone )
+{
+	Corpus2::Tag t1(Corpus2::mask_t(0));
+	Corpus2::Sentence::Ptr s = boost::make_shared<Corpus2::Sentence>("s1");
+	for (int i = 0; i < 100; ++i) {
+		Corpus2::Token* t = Corpus2::Token::create_utf8("t");
+		for (int l = 0; l <= i % 6; ++l) {
+			t->add_lexeme(Corpus2::Lexeme(UnicodeString::fromUTF8("t"), t1));
+		}
+		s->append(t);
+	}
+	Corpus2::Sentence::Ptr c = s->clone_shared();
+	BOOST_REQUIRE_EQUAL(c->size(), s->size());
+	BOOST_CHECK_EQUAL(c->id(), "s1");
+	for (size_t i = 0; i < s->size(); ++i) {
+		BOOST_CHECK((*c)[i] != (*s)[i]);
+		BOOST_CHECK(*(*c)[i] == *(*s)[i]);
+		BOOST_CHECK_EQUAL((*c)[i]->lexemes().size(), i % 6 + 1);
+	}
+}
+
 BOOST_AUTO_TEST_CASE( is_icu_working )
 {
 	std::string s("aaa");
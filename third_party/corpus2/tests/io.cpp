@@ -22,6 +22,7 @@ or FITNESS FOR A PARTICULAR PURPOSE.
 #include <libcorpus2/io/xcesreader.h>
 #include <libcorpus2/io/fastxces.h>
 #include <libcorpus2/io/writer.h>
+#include <libcorpus2/util/syllabifier.h>
 
 namespace {
 static char swiatopoglad[] =
@@ -200,5 +201,152 @@ BOOST_AUTO_TEST_CASE( create_reader )
 }
 
 
+BOOST_AUTO_TEST_CASE( bin_roundtrip )
+{
+	const Corpus2::Tagset& tagset = Corpus2::get_named_tagset("kipi");
+	std::stringstream ssin;
+	ssin << swiatopoglad;
+	Corpus2::XcesReader xr(tagset, ssin);
+	boost::shared_ptr<Corpus2::Chunk> chunk = xr.get_next_chunk();
+	std::stringstream ssbin;
+	boost::shared_ptr<Corpus2::TokenWriter> w(Corpus2::TokenWriter::create_stream_writer("bin", ssbin, tagset));
+	w->write_chunk(*chunk);
+	w->finish();
+
+	boost::shared_ptr<Corpus2::TokenReader> r;
+	r = Corpus2::TokenReader::create_stream_reader("bin", tagset, ssbin);
+	boost::shared_ptr<Corpus2::Chunk> chunk2 = r->get_next_chunk();
+	BOOST_REQUIRE(chunk2);
+	BOOST_CHECK(!r->get_next_chunk());
+	std::stringstream ss;
+	w = Corpus2::TokenWriter::create_stream_writer("xces,flat", ss, tagset);
+	w->write_chunk(*chunk2);
+	w->finish();
+	BOOST_CHECK_EQUAL(ss.str(), swiatopoglad);
+
+	ssbin.clear();
+	ssbin.seekg(0);
+	const Corpus2::Tagset& other = Corpus2::get_named_tagset("nkjp");
+	BOOST_CHECK_THROW(Corpus2::TokenReader::create_stream_reader("bin", other, ssbin),
+		Corpus2::Corpus2Error);
+}
+
+BOOST_AUTO_TEST_CASE( bin_free_sentences )
+{
+	const Corpus2::Tagset& tagset = Corpus2::get_named_tagset("kipi");
+	std::stringstream ssin;
+	ssin << swiatopoglad;
+	Corpus2::XcesReader xr(tagset, ssin);
+	boost::shared_ptr<Corpus2::Chunk> chunk = xr.get_next_chunk();
+	BOOST_REQUIRE(chunk);
+	const Corpus2::Sentence& sentence = *chunk->sentences()[0];
+	std::stringstream ssbin;
+	boost::shared_ptr<Corpus2::TokenWriter> w(Corpus2::TokenWriter::create_stream_writer("bin", ssbin, tagset));
+	w->write_sentence(sentence);
+	w->write_chunk(*chunk);
+	w->write_sentence(sentence);
+	w->write_sentence(sentence);
+	w->finish();
+
+	// sentences outside of chunks come in write order, as chunks of their own
+	boost::shared_ptr<Corpus2::TokenReader> r;
+	r = Corpus2::TokenReader::create_stream_reader("bin", tagset, ssbin);
+	boost::shared_ptr<Corpus2::Chunk> c = r->get_next_chunk();
+	BOOST_REQUIRE(c);
+	BOOST_CHECK_EQUAL(c->size(), 1);
+	BOOST_CHECK(c->attributes().empty());
+	c = r->get_next_chunk();
+	BOOST_REQUIRE(c);
+	BOOST_CHECK_EQUAL(c->size(), chunk->size());
+	BOOST_CHECK_EQUAL(c->get_attribute("id"), chunk->get_attribute("id"));
+	c = r->get_next_chunk();
+	BOOST_REQUIRE(c);
+	BOOST_CHECK_EQUAL(c->size(), 2);
+	BOOST_CHECK_EQUAL(c->sentences()[1]->size(), sentence.size());
+	BOOST_CHECK(!r->get_next_chunk());
+}
+
+BOOST_AUTO_TEST_CASE( bin_mixed_reading )
+{
+	const Corpus2::Tagset& tagset = Corpus2::get_named_tagset("kipi");
+	std::stringstream ssin;
+	ssin << swiatopoglad;
+	Corpus2::XcesReader xr(tagset, ssin);
+	boost::shared_ptr<Corpus2::Chunk> chunk = xr.get_next_chunk();
+	BOOST_REQUIRE(chunk);
+	const Corpus2::Sentence& sentence = *chunk->sentences()[0];
+	BOOST_REQUIRE(sentence.size() > 1);
+	Corpus2::Chunk two;
+	two.set_attribute("id", "two");
+	two.append(sentence.clone_shared());
+	two.append(sentence.clone_shared());
+	std::stringstream ssbin;
+	boost::shared_ptr<Corpus2::TokenWriter> w(Corpus2::TokenWriter::create_stream_writer("bin", ssbin, tagset));
+	w->write_chunk(two);
+	w->write_sentence(sentence);
+	w->finish();
+
+	// tokens, sentences and chunks are read from the same position
+	boost::shared_ptr<Corpus2::TokenReader> r;
+	r = Corpus2::TokenReader::create_stream_reader("bin", tagset, ssbin);
+	Corpus2::Sentence::Ptr s = r->get_next_sentence();
+	BOOST_REQUIRE(s);
+	BOOST_CHECK_EQUAL(s->size(), sentence.size());
+	Corpus2::Token* t = r->get_next_token();
+	BOOST_REQUIRE(t);
+	BOOST_CHECK(*t == *sentence[0]);
+	delete t;
+	boost::shared_ptr<Corpus2::Chunk> c = r->get_next_chunk();
+	BOOST_REQUIRE(c);
+	BOOST_CHECK_EQUAL(c->get_attribute("id"), "two");
+	BOOST_REQUIRE_EQUAL(c->size(), 1);
+	BOOST_CHECK_EQUAL(c->sentences()[0]->size(), sentence.size() - 1);
+	s = r->get_next_sentence();
+	BOOST_REQUIRE(s);
+	BOOST_CHECK_EQUAL(s->size(), sentence.size());
+	BOOST_CHECK(!r->get_next_chunk());
+}
+
+BOOST_AUTO_TEST_CASE( readability )
+{
+	const Corpus2::Tagset& tagset = Corpus2::get_named_tagset("kipi");
+	std::stringstream ssin;
+	ssin << swiatopoglad;
+	Corpus2::XcesReader xr(tagset, ssin);
+	boost::shared_ptr<Corpus2::Chunk> chunk = xr.get_next_chunk();
+	std::stringstream ss;
+	boost::shared_ptr<Corpus2::TokenWriter> w(Corpus2::TokenWriter::create_stream_writer("readability", ss, tagset));
+	w->write_chunk(*chunk);
+	w->finish();
+	BOOST_CHECK_EQUAL(ss.str(),
+		"{\"chunks\":[{\"id\":\"ch51\",\"sentences\":1,\"long_sentences\":0,"
+		"\"tokens\":4,\"words\":3,\"hard_words\":{\"fog_orth\":1,\"fog_base\":1,"
+		"\"pisarek_orth\":1,\"pisarek_base\":1,\"lix\":1}}],"
+		"\"document\":{\"paragraphs\":1,\"sentences\":1,\"long_sentences\":0,"
+		"\"tokens\":4,\"words\":3,\"hard_words\":{\"fog_orth\":1,\"fog_base\":1,"
+		"\"pisarek_orth\":1,\"pisarek_base\":1,\"lix\":1},"
+		"\"classes\":{\"conj\":1,\"fin\":1,\"subst\":1},"
+		"\"orth_length\":[0,0,1,0,0,0,1,0,0,0,0,0,1],"
+		"\"base_length\":[0,0,1,0,0,0,1,0,0,0,0,0,1],"
+		"\"orth_syllables\":[0,1,0,1,1],"
+		"\"base_syllables\":[0,1,0,1,1],"
+		"\"hard_word_count\":1,\"hard_word_forms\":[\"\xc5\x9bwiatopogl\xc4\x85" "d\"]}}\n");
+
+	std::stringstream ss2;
+	w = Corpus2::TokenWriter::create_stream_writer("readability,nochunks", ss2, tagset);
+	w->write_chunk(*chunk);
+	w->finish();
+	BOOST_CHECK_EQUAL(ss2.str().substr(0, 27), "{\"document\":{\"paragraphs\":1");
+}
+
+BOOST_AUTO_TEST_CASE( syllables )
+{
+	Corpus2::PolishSyllabifier s;
+	BOOST_CHECK_EQUAL(s.count_syllables(UnicodeString::fromUTF8("w")), 0);
+	BOOST_CHECK_EQUAL(s.count_syllables(UnicodeString::fromUTF8("nie")), 1);
+	BOOST_CHECK_EQUAL(s.count_syllables(UnicodeString::fromUTF8("Ziemia")), 2);
+	BOOST_CHECK_EQUAL(s.count_syllables(UnicodeString::fromUTF8("ogórek")), 3);
+	BOOST_CHECK_EQUAL(s.count_syllables(UnicodeString::fromUTF8("światopogląd")), 4);
+}
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,79 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libcorpus2 project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Lesser Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the LICENSE.CORPUS2, POLIQARP, COPYING.LESSER and COPYING files for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <libpwrutils/stagetimer.h>
+
+#include <sstream>
+
+BOOST_AUTO_TEST_SUITE( stagetimer )
+
+BOOST_AUTO_TEST_CASE( histogram )
+{
+	PwrNlp::StageStats s;
+	s.add(0, 1);
+	s.add(1, 1);
+	s.add(3, 1);
+	s.add(1000, 7);
+	BOOST_CHECK_EQUAL(s.calls, 4);
+	BOOST_CHECK_EQUAL(s.tokens, 10);
+	BOOST_CHECK_EQUAL(s.total_us, 1004);
+	BOOST_CHECK_EQUAL(s.max_us, 1000);
+	BOOST_CHECK_EQUAL(s.histogram[0], 1);
+	BOOST_CHECK_EQUAL(s.histogram[1], 1);
+	BOOST_CHECK_EQUAL(s.histogram[2], 1);
+	BOOST_CHECK_EQUAL(s.histogram[10], 1);
+	BOOST_CHECK_EQUAL(s.latency_quantile(0.5), 4);
+	BOOST_CHECK_EQUAL(s.latency_quantile(1.0), 1000);
+}
+
+BOOST_AUTO_TEST_CASE( profile_merge )
+{
+	PwrNlp::StageProfile a, b;
+	PwrNlp::StageStats& toki = a.stage("toki");
+	toki.add(10, 5);
+	b.stage("maca").add(20, 5);
+	b.stage("toki").add(30, 5);
+	a.merge(b);
+	BOOST_REQUIRE_EQUAL(a.stage_names().size(), 2);
+	BOOST_CHECK_EQUAL(a.stage_names()[0], "toki");
+	BOOST_CHECK_EQUAL(a.stage_names()[1], "maca");
+	BOOST_CHECK_EQUAL(toki.calls, 2);
+	BOOST_CHECK_EQUAL(toki.total_us, 40);
+	a.clear();
+	BOOST_CHECK_EQUAL(toki.calls, 0);
+	BOOST_CHECK(a.find("maca") != NULL);
+	BOOST_CHECK(a.find("crf") == NULL);
+}
+
+BOOST_AUTO_TEST_CASE( timer_json )
+{
+	PwrNlp::StageProfile p;
+	{
+		PwrNlp::StageTimer timer(&p.stage("read"), 3);
+	}
+	{
+		PwrNlp::StageTimer nothing(NULL, 3);
+	}
+	BOOST_CHECK_EQUAL(p.stage("read").calls, 1);
+	BOOST_CHECK_EQUAL(p.stage("read").tokens, 3);
+	std::ostringstream os;
+	p.write_json(os);
+	BOOST_CHECK_EQUAL(os.str().substr(0, 18), "{\"read\":{\"calls\":1");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -58,6 +58,11 @@ bool try_fold_paths(const std::vector< std::vector<Corpus2::Token*> >& v,
 	// actual merging
 	for (size_t ti = 0; ti < min_len; ++ti) {
 		Corpus2::Token* t = v[0][ti];
+		size_t lexemes = t->lexemes().size();
+		for (size_t pi = 1; pi < v.size(); ++pi) {
+			lexemes += v[pi][ti]->lexemes().size();
+		}
+		t->lexemes().reserve(lexemes);
 		for (size_t pi = 1; pi < v.size(); ++pi) {
 			BOOST_FOREACH(const Corpus2::Lexeme& lex, v[pi][ti]->lexemes()) {
 				t->add_lexeme(lex);
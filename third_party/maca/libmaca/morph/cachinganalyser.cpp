@@ -0,0 +1,274 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libmaca project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the LICENSE.MACA, LICENSE.SFST, LICENSE.GUESSER, COPYING.LESSER and COPYING files for more details.
+*/
+
+#include <libmaca/morph/cachinganalyser.h>
+#include <libmaca/exception.h>
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <list>
+
+namespace Maca {
+
+/**
+ * The analysis of a single orth, i.e. the tokens output by the wrapped
+ * analyser (none if the orth was not recognised).
+ */
+class CachedAnalysis : private boost::noncopyable
+{
+public:
+	~CachedAnalysis() {
+		BOOST_FOREACH(Corpus2::Token* t, tokens) {
+			delete t;
+		}
+	}
+
+	std::vector<Corpus2::Token*> tokens;
+};
+
+/**
+ * Bounded least-recently-used map of analyses keyed by orth and Toki type.
+ * All access is synchronised. Analyses are immutable once cached, so they
+ * are handed out as shared pointers and copied without holding the lock.
+ */
+class AnalysisCache : private boost::noncopyable
+{
+public:
+	typedef boost::shared_ptr<const CachedAnalysis> analysis_ptr;
+
+	explicit AnalysisCache(size_t capacity)
+		: capacity_(capacity), hits_(0), misses_(0)
+	{
+	}
+
+	/// Get cached analysis, counting a hit or a miss
+	analysis_ptr get(const UnicodeString& orth, const std::string& type)
+	{
+		boost::mutex::scoped_lock lock(mutex_);
+		index_t::iterator i = index_.find(Key(orth, type));
+		if (i == index_.end()) {
+			++misses_;
+			return analysis_ptr();
+		}
+		++hits_;
+		// mark as most recently used
+		entries_.splice(entries_.begin(), entries_, i->second);
+		return i->second->second;
+	}
+
+	/// Store analysis, forgetting the least recently used if full
+	void put(const UnicodeString& orth, const std::string& type,
+			analysis_ptr analysis)
+	{
+		if (capacity_ == 0) return;
+		boost::mutex::scoped_lock lock(mutex_);
+		Key key(orth, type);
+		if (index_.find(key) != index_.end()) {
+			// cached by another clone in the meantime
+			return;
+		}
+		if (index_.size() >= capacity_) {
+			index_.erase(entries_.back().first);
+			entries_.pop_back();
+		}
+		entries_.push_front(std::make_pair(key, analysis));
+		index_[key] = entries_.begin();
+	}
+
+	size_t hits() {
+		boost::mutex::scoped_lock lock(mutex_);
+		return hits_;
+	}
+
+	size_t misses() {
+		boost::mutex::scoped_lock lock(mutex_);
+		return misses_;
+	}
+
+	size_t size() {
+		boost::mutex::scoped_lock lock(mutex_);
+		return index_.size();
+	}
+
+	size_t capacity() const {
+		return capacity_;
+	}
+
+	void clear() {
+		boost::mutex::scoped_lock lock(mutex_);
+		index_.clear();
+		entries_.clear();
+		hits_ = 0;
+		misses_ = 0;
+	}
+
+private:
+	/// Cache key: orth and Toki type
+	struct Key
+	{
+		Key(const UnicodeString& orth, const std::string& type)
+			: orth(orth), type(type)
+		{
+		}
+
+		bool operator==(const Key& other) const {
+			return orth == other.orth && type == other.type;
+		}
+
+		UnicodeString orth;
+		std::string type;
+	};
+
+	/// Helper struct for key hashing
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& k) const {
+			std::size_t seed = k.orth.hashCode();
+			boost::hash_combine(seed, k.type);
+			return seed;
+		}
+	};
+
+	typedef std::list< std::pair<Key, analysis_ptr> > entries_t;
+	typedef boost::unordered_map<Key, entries_t::iterator, KeyHash> index_t;
+
+	/// Maximum number of entries
+	const size_t capacity_;
+
+	/// Entries, most recently used first
+	entries_t entries_;
+
+	/// Key to entry map
+	index_t index_;
+
+	/// Counters
+	size_t hits_, misses_;
+
+	/// Guards all the above
+	boost::mutex mutex_;
+};
+
+const char* CachingAnalyser::identifier = "wrap_cache";
+
+bool CachingAnalyser::registered =
+		MorphAnalyser::register_analyser<CachingAnalyser>();
+
+const size_t CachingAnalyser::default_cache_size = 100000;
+
+CachingAnalyser::CachingAnalyser(MorphAnalyser *ma, size_t cache_size)
+	: MorphAnalyser(&ma->tagset()), wrapped_(ma)
+	, cache_(boost::make_shared<AnalysisCache>(cache_size))
+{
+}
+
+CachingAnalyser::CachingAnalyser(MorphAnalyser *ma,
+		boost::shared_ptr<AnalysisCache> cache)
+	: MorphAnalyser(&ma->tagset()), wrapped_(ma), cache_(cache)
+{
+}
+
+CachingAnalyser::CachingAnalyser(const Config::Node &cfg)
+	: MorphAnalyser(cfg), wrapped_(NULL)
+	, cache_(boost::make_shared<AnalysisCache>(
+			cfg.get("cache_size", default_cache_size)))
+{
+	std::string wrapped_id = cfg.get("wrapped_class", "");
+	try {
+		wrapped_.reset(MorphAnalyser::create(wrapped_id, cfg));
+	} catch (MorphAnalyserFactoryException&) {
+		if (cfg.get("plugin_autoload", true)) {
+			if (MorphAnalyser::load_plugin(wrapped_id, false)) {
+				try {
+					wrapped_.reset(MorphAnalyser::create(wrapped_id, cfg));
+				} catch (MorphAnalyserFactoryException&) {
+					throw MacaError("Unknown analyser type: " + wrapped_id +
+							" (plugin found but create failed)");
+				}
+			} else {
+				throw MacaError("Unknown analyser type: " + wrapped_id +
+						" (plugin not found)");
+			}
+		} else {
+			throw MacaError("Unknown analyser type: " + wrapped_id);
+		}
+	}
+
+	Corpus2::require_matching_tagsets(*wrapped_, *this,
+			"Caching analyser creation");
+}
+
+CachingAnalyser::~CachingAnalyser()
+{
+}
+
+CachingAnalyser* CachingAnalyser::clone() const
+{
+	return new CachingAnalyser(wrapped_->clone(), cache_);
+}
+
+bool CachingAnalyser::process_functional(const Toki::Token &t,
+		boost::function<void (Corpus2::Token *)> sink)
+{
+	AnalysisCache::analysis_ptr cached = cache_->get(t.orth(), t.type());
+	if (!cached) {
+		boost::shared_ptr<CachedAnalysis> analysis =
+				boost::make_shared<CachedAnalysis>();
+		wrapped_->process(t, analysis->tokens);
+		cache_->put(t.orth(), t.type(), analysis);
+		cached = analysis;
+	}
+
+	for (size_t i = 0; i < cached->tokens.size(); ++i) {
+		Corpus2::Token* copy = cached->tokens[i]->clone();
+		if (i == 0) {
+			copy->set_wa(t.preceeding_whitespace());
+		}
+		sink(copy);
+	}
+	return !cached->tokens.empty();
+}
+
+size_t CachingAnalyser::cache_hits() const
+{
+	return cache_->hits();
+}
+
+size_t CachingAnalyser::cache_misses() const
+{
+	return cache_->misses();
+}
+
+size_t CachingAnalyser::cache_size() const
+{
+	return cache_->size();
+}
+
+size_t CachingAnalyser::cache_capacity() const
+{
+	return cache_->capacity();
+}
+
+void CachingAnalyser::clear_cache()
+{
+	cache_->clear();
+}
+
+} /* end ns Maca */
@@ -0,0 +1,110 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libmaca project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the LICENSE.MACA, LICENSE.SFST, LICENSE.GUESSER, COPYING.LESSER and COPYING files for more details.
+*/
+
+#ifndef LIBMACA_MORPH_CACHINGANALYSER_H
+#define LIBMACA_MORPH_CACHINGANALYSER_H
+
+#include <libmaca/morph/morphanalyser.h>
+#include <boost/scoped_ptr.hpp>
+
+namespace Maca {
+
+/// forward declaration of the cache shared between analyser clones
+class AnalysisCache;
+
+/**
+ * A wrapper analyser that remembers the output of some analyser.
+ *
+ * Analyses are cached by the orth and Toki type of the token, so the
+ * wrapped analyser should not depend on anything else (which holds for
+ * dictionary-based analysers). Tokens the wrapped analyser does not
+ * recognise are remembered as well. When the cache is full, the least
+ * recently used analysis is forgotten.
+ *
+ * Returned tokens are copies of the cached ones, with the whitespace of the
+ * first token taken from the analysed Toki token.
+ *
+ * The cache is shared between clones of the analyser and may be used
+ * from many threads, while each clone has its own copy of the wrapped
+ * analyser.
+ *
+ * Configuration class key: \b wrap_cache
+ */
+class CachingAnalyser : public MorphAnalyser
+{
+public:
+	/// Default maximum number of cached analyses
+	static const size_t default_cache_size;
+
+	/**
+	 * Create a caching analyser wrapping the given analyser (ownership is
+	 * taken) and caching at most cache_size analyses.
+	 */
+	CachingAnalyser(MorphAnalyser* ma, size_t cache_size = default_cache_size);
+
+	/**
+	 * Config node constructor. Recognized keys are:
+	 * - wrapped_class - the actual analyser to instantiate and wrap
+	 * - cache_size - maximum number of cached analyses (default 100000)
+	 * Keys are passed to the wrapped analyser.
+	 */
+	explicit CachingAnalyser(const Config::Node& cfg);
+
+	/// Destructor
+	~CachingAnalyser();
+
+	/// Cloning, the clone shares the cache with this analyser
+	CachingAnalyser* clone() const;
+
+	/// MorphAnalyser override
+	bool process_functional(const Toki::Token &t
+			, boost::function<void (Corpus2::Token*)> sink);
+
+	/// Number of analyses served from the cache so far
+	size_t cache_hits() const;
+
+	/// Number of analyses passed to the wrapped analyser so far
+	size_t cache_misses() const;
+
+	/// Number of analyses currently cached
+	size_t cache_size() const;
+
+	/// Maximum number of cached analyses
+	size_t cache_capacity() const;
+
+	/// Forget all cached analyses and reset the counters
+	void clear_cache();
+
+	/// Class identifier
+	static const char* identifier;
+
+	/// Registered flag
+	static bool registered;
+
+private:
+	/// ctor for use in clone()
+	CachingAnalyser(MorphAnalyser* ma, boost::shared_ptr<AnalysisCache> cache);
+
+	/// The wrapped analyser
+	boost::scoped_ptr<MorphAnalyser> wrapped_;
+
+	/// The cache, shared between clones
+	boost::shared_ptr<AnalysisCache> cache_;
+};
+
+} /* end ns Maca */
+
+#endif // LIBMACA_MORPH_CACHINGANALYSER_H
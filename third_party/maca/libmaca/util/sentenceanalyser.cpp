@@ -28,6 +28,7 @@ SentenceAnalyser::SentenceAnalyser(
 		const boost::shared_ptr<Toki::Tokenizer>& tok,
 		const boost::shared_ptr<MorphAnalyser>& ma)
 	: UnicodeSink(), tok_(tok), sp_(*tok_), ma_(ma)
+	, tokenize_stats_(NULL), analyse_stats_(NULL)
 {
 }
 
@@ -37,6 +38,7 @@ SentenceAnalyser::SentenceAnalyser(const Config::Node &cfg)
 		cfg.get("general.toki-config", "")))
 	, sp_(*tok_)
 	, ma_(new DispatchAnalyser(cfg))
+	, tokenize_stats_(NULL), analyse_stats_(NULL)
 {
 }
 
@@ -46,6 +48,7 @@ SentenceAnalyser::SentenceAnalyser(const Config::Node &cfg,
 	, tok_(new Toki::LayerTokenizer(toki_config_override))
 	, sp_(*tok_)
 	, ma_(new DispatchAnalyser(cfg))
+	, tokenize_stats_(NULL), analyse_stats_(NULL)
 {
 }
 
@@ -73,13 +76,28 @@ std::string SentenceAnalyser::available_configurations()
 	return boost::algorithm::join(Path::Instance().list_files(".ini"), " ");
 }
 
+void SentenceAnalyser::set_profile(PwrNlp::StageProfile* profile)
+{
+	if (profile) {
+		tokenize_stats_ = &profile->stage("toki");
+		analyse_stats_ = &profile->stage("maca");
+	} else {
+		tokenize_stats_ = analyse_stats_ = NULL;
+	}
+}
+
 Corpus2::Sentence::Ptr SentenceAnalyser::get_next_sentence()
 {
+	PwrNlp::StageTimer tokenize_timer(tokenize_stats_);
 	if (sp_.has_more()) {
 		boost::scoped_ptr<Toki::Sentence> toki_sentence(
 				sp_.get_next_sentence());
 		assert(toki_sentence);
 		assert(!toki_sentence->empty());
+		tokenize_timer.set_tokens(toki_sentence->size());
+		tokenize_timer.stop();
+		PwrNlp::StageTimer analyse_timer(analyse_stats_,
+				toki_sentence->size());
 		return ma_->process(*toki_sentence);
 	} else {
 		return Corpus2::Sentence::Ptr();
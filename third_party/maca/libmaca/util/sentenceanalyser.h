@@ -21,6 +21,7 @@ or FITNESS FOR A PARTICULAR PURPOSE.
 #include <libtoki/sentencesplitter.h>
 #include <libmaca/morph/morphanalyser.h>
 #include <libmaca/util/confignode.h>
+#include <libpwrutils/stagetimer.h>
 
 namespace Maca {
 
@@ -76,6 +77,13 @@ public:
 		return ma_->tagset();
 	}
 
+	/**
+	 * Time tokenization and morphological analysis of each sentence into
+	 * the "toki" and "maca" stages of the given profile, which must
+	 * outlive the analyser or be replaced first. NULL switches timing off.
+	 */
+	void set_profile(PwrNlp::StageProfile* profile);
+
 protected:
 	void new_input_source();
 
@@ -85,6 +93,10 @@ private:
 	Toki::SentenceSplitter sp_;
 
 	boost::shared_ptr<MorphAnalyser> ma_;
+
+	PwrNlp::StageStats* tokenize_stats_;
+
+	PwrNlp::StageStats* analyse_stats_;
 };
 
 } /* end ns Maca */
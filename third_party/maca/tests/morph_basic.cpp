@@ -16,6 +16,7 @@ or FITNESS FOR A PARTICULAR PURPOSE.
 
 #include <boost/test/unit_test.hpp>
 
+#include <libmaca/morph/cachinganalyser.h>
 #include <libmaca/morph/constanalyser.h>
 #include <libmaca/morph/dispatchanalyser.h>
 #include <libcorpus2/tagsetparser.h>
@@ -118,3 +119,83 @@ BOOST_FIXTURE_TEST_CASE( morph_dispatch4, Fd )
 	t.set_type("ZZZ");
 	BOOST_CHECK_THROW(a.process(t), Maca::MacaError);
 }
+
+struct Fc : public F
+{
+	Fc() : F() {
+		tag1s = "P1:a2:b1";
+		tag2s = "P2:a1";
+		Maca::DispatchAnalyser* d = new Maca::DispatchAnalyser(tagset.get());
+		d->add_type_handler("t", new Maca::ConstAnalyser(tagset.get(), tag1s));
+		d->add_type_handler("a", new Maca::ConstAnalyser(tagset.get(), tag2s));
+		a.reset(new Maca::CachingAnalyser(d, 2));
+	}
+
+	std::string analyse(const Toki::Token& tok) {
+		std::vector<Corpus2::Token*> tv = a->process(tok);
+		BOOST_REQUIRE_EQUAL(tv.size(), 1);
+		BOOST_REQUIRE_EQUAL(tv[0]->lexemes().size(), 1);
+		BOOST_CHECK(tv[0]->orth() == tok.orth());
+		BOOST_CHECK_EQUAL(tv[0]->wa(), tok.preceeding_whitespace());
+		std::string tag = tagset->tag_to_string(tv[0]->lexemes()[0].tag());
+		delete tv[0];
+		return tag;
+	}
+
+	boost::scoped_ptr<Maca::CachingAnalyser> a;
+	std::string tag1s;
+	std::string tag2s;
+};
+
+BOOST_FIXTURE_TEST_CASE( morph_cache_hit, Fc )
+{
+	BOOST_CHECK_EQUAL(analyse(t), tag1s);
+	BOOST_CHECK_EQUAL(a->cache_misses(), 1);
+	BOOST_CHECK_EQUAL(a->cache_hits(), 0);
+	t.set_preceeding_whitespace(PwrNlp::Whitespace::None);
+	BOOST_CHECK_EQUAL(analyse(t), tag1s);
+	BOOST_CHECK_EQUAL(a->cache_misses(), 1);
+	BOOST_CHECK_EQUAL(a->cache_hits(), 1);
+	BOOST_CHECK_EQUAL(a->cache_size(), 1);
+}
+
+BOOST_FIXTURE_TEST_CASE( morph_cache_type, Fc )
+{
+	BOOST_CHECK_EQUAL(analyse(t), tag1s);
+	t.set_type("a");
+	BOOST_CHECK_EQUAL(analyse(t), tag2s);
+	BOOST_CHECK_EQUAL(a->cache_misses(), 2);
+	BOOST_CHECK_EQUAL(a->cache_size(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE( morph_cache_evict, Fc )
+{
+	Toki::Token t2(UnicodeString::fromUTF8("bbb"), "t", PwrNlp::Whitespace::Space);
+	Toki::Token t3(UnicodeString::fromUTF8("ccc"), "t", PwrNlp::Whitespace::Space);
+	analyse(t);
+	analyse(t2);
+	analyse(t);
+	// t2 is now the least recently used one
+	analyse(t3);
+	BOOST_CHECK_EQUAL(a->cache_size(), 2);
+	BOOST_CHECK_EQUAL(a->cache_misses(), 3);
+	analyse(t);
+	BOOST_CHECK_EQUAL(a->cache_misses(), 3);
+	analyse(t2);
+	BOOST_CHECK_EQUAL(a->cache_misses(), 4);
+	a->clear_cache();
+	BOOST_CHECK_EQUAL(a->cache_size(), 0);
+	BOOST_CHECK_EQUAL(a->cache_hits(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE( morph_cache_clone, Fc )
+{
+	boost::scoped_ptr<Maca::CachingAnalyser> c(a->clone());
+	analyse(t);
+	std::vector<Corpus2::Token*> tv = c->process(t);
+	BOOST_REQUIRE_EQUAL(tv.size(), 1);
+	BOOST_CHECK_EQUAL(tagset->tag_to_string(tv[0]->lexemes()[0].tag()), tag1s);
+	delete tv[0];
+	BOOST_CHECK_EQUAL(a->cache_hits(), 1);
+	BOOST_CHECK_EQUAL(c->cache_misses(), 1);
+}
@@ -0,0 +1,167 @@
+/*
+    Copyright (C) 2010 Tomasz Śniatowski, Adam Radziszewski
+    Part of the libtoki project
+
+    This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the Free
+Software Foundation; either version 3 of the License, or (at your option)
+any later version.
+
+    This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the LICENSE, COPYING.LESSER and COPYING files for more details.
+*/
+
+/**
+ * @file srx_bench.cpp
+ * @brief Sentence splitting throughput of the SRX segmenters.
+ *
+ * The texts are split with each of the compared segmenters through
+ * Srx::SourceWrapper, with the window and margin the tokenizer uses by
+ * default. Sentence breaks found by each segmenter are checked against
+ * the ones found by the first.
+ */
+
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
+#include <boost/program_options.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <libtoki/srx/document.h>
+#include <libtoki/srx/segmenter.h>
+#include <libtoki/srx/srx.h>
+#include <libtoki/unicode/icustringwrapper.h>
+
+const std::string USAGE = "Usage: toki-srx-bench [options] SRX LANGUAGE TEXT...\n\
+\n\
+Splits the UTF-8 TEXT files into sentences with each of the compared SRX\n\
+segmenters and reports the speed.\n";
+
+void report(const std::string& name, size_t chars, clock_t start, clock_t end)
+{
+	const double seconds = static_cast<double>(end - start) / CLOCKS_PER_SEC;
+	std::cout << name << ": " << chars << " chars in " << seconds << " s";
+	if (seconds > 0)
+		std::cout << ", " << static_cast<size_t>(chars / seconds) << " chars/s";
+	std::cout << std::endl;
+}
+
+std::vector<int> split(const UnicodeString& text,
+		const boost::shared_ptr<Toki::Srx::Segmenter>& segm,
+		int window, int margin)
+{
+	boost::shared_ptr<Toki::UnicodeIcuStringWrapper> src(
+			new Toki::UnicodeIcuStringWrapper(text));
+	Toki::Srx::SourceWrapper srx(src, segm, window, margin);
+	std::vector<int> breaks;
+	int i = 0;
+	while (srx.has_more_chars()) {
+		if (srx.peek_begins_sentence()) {
+			breaks.push_back(i);
+		}
+		++i;
+		srx.get_next_char();
+	}
+	return breaks;
+}
+
+int main(int argc, char** argv)
+{
+	std::string srx_path, language, segmenters;
+	std::vector<std::string> files;
+	int window, margin;
+	using boost::program_options::value;
+	boost::program_options::options_description desc("Allowed options");
+	desc.add_options()
+			("srx", value(&srx_path), "SRX file")
+			("lang", value(&language), "SRX language selection")
+			("text", value(&files), "Text files")
+			("segmenters,s", value(&segmenters)->default_value("icu;icu-prefilter"),
+			 "Compared segmenters, separated by semicolons")
+			("window,w", value(&window)->default_value(10000),
+			 "SRX window size")
+			("margin,m", value(&margin)->default_value(100),
+			 "SRX margin size")
+			("help,h", "Show help")
+			;
+	boost::program_options::positional_options_description p;
+	p.add("srx", 1).add("lang", 1).add("text", -1);
+	boost::program_options::variables_map vm;
+	try {
+		boost::program_options::store(
+				boost::program_options::command_line_parser(argc, argv)
+				.options(desc).positional(p).run(), vm);
+	} catch (boost::program_options::error& e) {
+		std::cerr << e.what() << "\n";
+		return 2;
+	}
+	boost::program_options::notify(vm);
+
+	if (vm.count("help") || files.empty()) {
+		std::cerr << USAGE << "\n" << desc << "\n";
+		return 1;
+	}
+
+	try {
+		std::ifstream srx_ifs(srx_path.c_str());
+		if (!srx_ifs.good()) {
+			std::cerr << "Cannot open " << srx_path << "\n";
+			return EXIT_FAILURE;
+		}
+		Toki::Srx::Document doc;
+		doc.load(srx_ifs);
+		const std::vector<Toki::Srx::Rule> rules = doc.get_rules_for_lang(language);
+		std::cout << rules.size() << " rules for " << language << std::endl;
+
+		std::vector<UnicodeString> texts;
+		size_t chars = 0;
+		BOOST_FOREACH (const std::string& f, files) {
+			std::ifstream ifs(f.c_str());
+			std::string s((std::istreambuf_iterator<char>(ifs)),
+					std::istreambuf_iterator<char>());
+			texts.push_back(UnicodeString::fromUTF8(s));
+			chars += texts.back().length();
+		}
+
+		std::vector<std::string> names;
+		boost::algorithm::split(names, segmenters, boost::is_any_of(";"));
+		std::vector< std::vector<int> > reference;
+		int status = EXIT_SUCCESS;
+		BOOST_FOREACH (const std::string& name, names) {
+			boost::shared_ptr<Toki::Srx::Segmenter> segm(
+					Toki::Srx::Segmenter::get_segmenter_by_name(name));
+			if (!segm) {
+				std::cerr << "Unknown segmenter: " << name << "\n";
+				return EXIT_FAILURE;
+			}
+			segm->load_rules(rules);
+			std::vector< std::vector<int> > breaks;
+			size_t sentences = 0;
+			clock_t start = clock();
+			BOOST_FOREACH (const UnicodeString& text, texts) {
+				breaks.push_back(split(text, segm, window, margin));
+				sentences += breaks.back().size();
+			}
+			report(name, chars, start, clock());
+			std::cout << "  " << sentences << " breaks" << std::endl;
+			if (reference.empty()) {
+				reference.swap(breaks);
+			} else if (breaks != reference) {
+				std::cerr << "  breaks differ from " << names[0] << "\n";
+				status = EXIT_FAILURE;
+			}
+		}
+		return status;
+	} catch (std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+}
@@ -19,6 +19,12 @@ or FITNESS FOR A PARTICULAR PURPOSE.
 #include <boost/foreach.hpp>
 #include <libpwrutils/util.h>
 
+#include <unicode/utf16.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <map>
 #include <iostream>
 #include <sstream>
@@ -58,6 +64,7 @@ Segmenter* Segmenter::get_segmenter_by_name(const std::string &name)
 	if (name == "boost") return new NaiveBoostSegmenter;
 #endif
 	if (name == "icu-hxo") return new HxoIcuSegmenter;
+	if (name == "icu-prefilter") return new PrefilterIcuSegmenter;
 	return NULL;
 }
 
@@ -244,6 +251,481 @@ void HxoIcuSegmenter::compute_breaks(const UnicodeString &str, int from,
 	}
 }
 
+namespace {
+
+	/// White space as matched by \s, with some extra characters to be safe
+	const char* whitespace_set =
+		"[\\t\\n\\u000B\\f\\r\\u001C-\\u001F\\u0085\\p{Z}\\p{WhiteSpace}]";
+
+	/**
+	 * Parse an escape sequence at i (pointing at the backslash) that
+	 * stands for a single character. Returns the index after the sequence
+	 * or -1 if it is not a known single character escape.
+	 */
+	int parse_char_escape(const UnicodeString& p, int i, UChar32& c)
+	{
+		if (i + 1 >= p.length()) return -1;
+		UChar e = p[i + 1];
+		switch (e) {
+		case 't': c = '\t'; return i + 2;
+		case 'n': c = '\n'; return i + 2;
+		case 'r': c = '\r'; return i + 2;
+		case 'f': c = '\f'; return i + 2;
+		case 'a': c = 0x07; return i + 2;
+		case 'e': c = 0x1b; return i + 2;
+		case 'u': {
+			if (i + 6 > p.length()) return -1;
+			UnicodeString hex(p, i + 2, 4);
+			std::string h = PwrNlp::to_utf8(hex);
+			char* end;
+			c = strtol(h.c_str(), &end, 16);
+			if (end != h.c_str() + 4) return -1;
+			return i + 6;
+		}
+		default:
+			// escaped ASCII punctuation stands for itself
+			if (e < 0x80 && !isalnum(e)) {
+				c = e;
+				return i + 2;
+			}
+		}
+		return -1;
+	}
+
+	/**
+	 * Parse a \s, \d, \p or \P escape at i into a set of characters.
+	 * Returns the index after the escape or -1.
+	 */
+	int parse_set_escape(const UnicodeString& p, int i, UnicodeSet& set)
+	{
+		if (i + 1 >= p.length()) return -1;
+		UChar e = p[i + 1];
+		UErrorCode status = U_ZERO_ERROR;
+		if (e == 's') {
+			set.applyPattern(UnicodeString::fromUTF8(whitespace_set), status);
+			return U_SUCCESS(status) ? i + 2 : -1;
+		} else if (e == 'd') {
+			set.applyPattern(UNICODE_STRING_SIMPLE("[\\p{Nd}]"), status);
+			return U_SUCCESS(status) ? i + 2 : -1;
+		} else if (e == 'p' || e == 'P') {
+			int end;
+			if (i + 2 < p.length() && p[i + 2] == '{') {
+				end = p.indexOf((UChar)'}', i + 3);
+				if (end < 0) return -1;
+				++end;
+			} else {
+				end = i + 3;
+				if (end > p.length()) return -1;
+			}
+			UnicodeString prop("[");
+			prop.append(p, i, end - i).append((UChar)']');
+			set.applyPattern(prop, status);
+			return U_SUCCESS(status) ? end : -1;
+		}
+		return -1;
+	}
+
+	/**
+	 * Parse a bracketed character class at i (pointing at the opening
+	 * bracket) into a set of characters. Only plain members, ranges,
+	 * nested classes and a trailing intersection or difference with a
+	 * nested class are supported. Returns the index after the class or -1.
+	 */
+	int parse_class(const UnicodeString& p, int i, UnicodeSet& set)
+	{
+		set.clear();
+		++i;
+		if (i < p.length() && p[i] == ':') return -1; // POSIX-like class
+		bool negate = false;
+		if (i < p.length() && p[i] == '^') {
+			negate = true;
+			++i;
+		}
+		bool first = true;
+		bool operation_done = false;
+		while (i < p.length()) {
+			UChar c = p[i];
+			if (c == ']') {
+				if (first) return -1;
+				if (negate) set.complement();
+				return i + 1;
+			}
+			if (operation_done) return -1;
+			first = false;
+			if (c == '[') {
+				UnicodeSet sub;
+				i = parse_class(p, i, sub);
+				if (i < 0) return -1;
+				set.addAll(sub);
+				continue;
+			}
+			if ((c == '&' || c == '-') && i + 1 < p.length() && p[i + 1] == c) {
+				UnicodeSet sub;
+				if (i + 2 >= p.length() || p[i + 2] != '[') return -1;
+				i = parse_class(p, i + 2, sub);
+				if (i < 0) return -1;
+				if (c == '&') {
+					set.retainAll(sub);
+				} else {
+					set.removeAll(sub);
+				}
+				operation_done = true;
+				continue;
+			}
+			UChar32 lo;
+			if (c == '\\') {
+				UnicodeSet sub;
+				int j = parse_set_escape(p, i, sub);
+				if (j >= 0) {
+					set.addAll(sub);
+					i = j;
+					continue;
+				}
+				i = parse_char_escape(p, i, lo);
+				if (i < 0) return -1;
+			} else {
+				lo = p.char32At(i);
+				i += U16_LENGTH(lo);
+			}
+			if (i + 1 < p.length() && p[i] == '-' && p[i + 1] != ']') {
+				UChar32 hi;
+				++i;
+				if (p[i] == '\\') {
+					i = parse_char_escape(p, i, hi);
+					if (i < 0) return -1;
+				} else if (p[i] == '[') {
+					return -1;
+				} else {
+					hi = p.char32At(i);
+					i += U16_LENGTH(hi);
+				}
+				if (hi < lo) return -1;
+				set.add(lo, hi);
+			} else {
+				set.add(lo);
+			}
+		}
+		return -1;
+	}
+
+	/**
+	 * Parse a single pattern element at i into the set of characters it
+	 * matches; c is set if it is a literal character and -1 otherwise.
+	 * Returns the index after the element or -1 if not supported.
+	 */
+	int parse_atom(const UnicodeString& p, int i, UnicodeSet& set, UChar32& c)
+	{
+		set.clear();
+		c = -1;
+		UChar u = p[i];
+		if (u == '\\') {
+			int j = parse_set_escape(p, i, set);
+			if (j >= 0) return j;
+			j = parse_char_escape(p, i, c);
+			if (j >= 0) set.add(c);
+			return j;
+		} else if (u == '[') {
+			return parse_class(p, i, set);
+		} else if (u < 0x80 && strchr("^$.|?*+(){}]", u)) {
+			return -1;
+		}
+		c = p.char32At(i);
+		set.add(c);
+		return i + U16_LENGTH(c);
+	}
+
+	/// Index after the group opening at i, or -1
+	int skip_group(const UnicodeString& p, int i)
+	{
+		int depth = 0;
+		bool in_class = false;
+		for (; i < p.length(); ++i) {
+			UChar u = p[i];
+			if (u == '\\') {
+				++i;
+			} else if (in_class) {
+				if (u == ']') in_class = false;
+			} else if (u == '[') {
+				in_class = true;
+			} else if (u == '(') {
+				++depth;
+			} else if (u == ')') {
+				if (--depth == 0) return i + 1;
+			}
+		}
+		return -1;
+	}
+
+	/// Whether the pattern has an alternation outside of any group
+	bool has_top_level_alternation(const UnicodeString& p)
+	{
+		int depth = 0;
+		int class_depth = 0;
+		for (int i = 0; i < p.length(); ++i) {
+			UChar u = p[i];
+			if (u == '\\') {
+				++i;
+			} else if (u == '[') {
+				++class_depth;
+			} else if (class_depth > 0) {
+				if (u == ']') --class_depth;
+			} else if (u == '(') {
+				++depth;
+			} else if (u == ')') {
+				--depth;
+			} else if (u == '|' && depth == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// Whether a quantifier at i allows zero occurrences
+	bool is_optional(const UnicodeString& p, int i)
+	{
+		if (i >= p.length()) return false;
+		return p[i] == '?' || p[i] == '*' || (p[i] == '{'
+				&& i + 1 < p.length() && p[i + 1] == '0');
+	}
+
+	/// Whether a quantifier at i allows more than one occurrence
+	bool is_repeated(const UnicodeString& p, int i)
+	{
+		if (i >= p.length()) return false;
+		return p[i] == '+' || p[i] == '*' || p[i] == '{';
+	}
+
+	/// Index after the quantifier at i, or -1
+	int skip_quantifier(const UnicodeString& p, int i)
+	{
+		if (p[i] == '{') {
+			i = p.indexOf((UChar)'}', i);
+			if (i < 0) return -1;
+		}
+		++i;
+		// lazy and possessive modifiers
+		if (i < p.length() && (p[i] == '?' || p[i] == '+')) ++i;
+		return i;
+	}
+
+	/**
+	 * Find the sets of characters at the first few positions of every
+	 * match of a pattern. Returns false if not even the first set could
+	 * be determined.
+	 */
+	bool analyse_pattern(const UnicodeString& p,
+			std::vector<UnicodeSet>& shape)
+	{
+		if (p.isEmpty() || has_top_level_alternation(p)) return false;
+		// anchored rules are matched at the start only anyway
+		if (p[0] == '^') return false;
+		int i = 0;
+		// zero-width assertions do not consume characters
+		while (i < p.length()) {
+			if (p.compare(i, 2, UNICODE_STRING_SIMPLE("\\b")) == 0
+					|| p.compare(i, 2, UNICODE_STRING_SIMPLE("\\B")) == 0) {
+				i += 2;
+			} else if (p.compare(i, 4, UNICODE_STRING_SIMPLE("(?<=")) == 0
+					|| p.compare(i, 4, UNICODE_STRING_SIMPLE("(?<!")) == 0) {
+				i = skip_group(p, i);
+				if (i < 0) return false;
+			} else {
+				break;
+			}
+		}
+		// leading optional elements add to the set of start characters
+		UnicodeSet first;
+		bool optional_seen = false;
+		UnicodeSet set;
+		UChar32 c;
+		int next;
+		for (;;) {
+			if (i >= p.length()) return false;
+			next = parse_atom(p, i, set, c);
+			if (next < 0) return false;
+			first.addAll(set);
+			if (!is_optional(p, next)) break;
+			optional_seen = true;
+			i = skip_quantifier(p, next);
+			if (i < 0) return false;
+		}
+		shape.push_back(first);
+		if (optional_seen) return true;
+		// following elements matching exactly one character each
+		while (!is_repeated(p, next) && next < p.length()) {
+			next = parse_atom(p, next, set, c);
+			if (next < 0 || is_optional(p, next)) break;
+			shape.push_back(set);
+		}
+		return true;
+	}
+
+	/// Whether the characters at s are in the consecutive sets of a shape
+	bool shape_matches(const std::vector<UnicodeSet>& shape,
+			const UChar* buf, int len, int s)
+	{
+		BOOST_FOREACH (const UnicodeSet& set, shape) {
+			if (s >= len) return false;
+			UChar32 c;
+			U16_NEXT(buf, s, len, c);
+			if (!set.contains(c)) return false;
+		}
+		return true;
+	}
+
+} /* end anon ns */
+
+PrefilterIcuSegmenter::PrefilterIcuSegmenter()
+{
+}
+
+PrefilterIcuSegmenter::~PrefilterIcuSegmenter()
+{
+	BOOST_FOREACH (const CompiledRule& cr, crules_) {
+		delete cr.matcher;
+	}
+}
+
+void PrefilterIcuSegmenter::load_rules(const std::vector<Rule>& rules)
+{
+	// rules that may start with each UTF-16 code unit
+	std::vector< std::vector<int> > unit_rules(0x10000);
+	BOOST_FOREACH (const Rule& r, rules) {
+		UErrorCode status = U_ZERO_ERROR;
+		CompiledRule cr = r.compile(status);
+		if (!U_SUCCESS(status)) {
+			std::stringstream ss;
+			ss << r.before << " : " << r.after;
+			throw SrxError("Rule failed to compile: " + ss.str());
+		}
+		int idx = crules_.size();
+		crules_.push_back(cr);
+		std::vector<UnicodeSet> shape;
+		UnicodeString head = UnicodeString::fromUTF8(
+				r.before.empty() ? r.after : r.before);
+		if (analyse_pattern(head, shape)) {
+			const UnicodeSet& first = shape[0];
+			for (int ri = 0; ri < first.getRangeCount(); ++ri) {
+				UChar32 lo = first.getRangeStart(ri);
+				UChar32 hi = first.getRangeEnd(ri);
+				for (UChar32 c = lo; c <= hi && c <= 0xffff; ++c) {
+					unit_rules[c].push_back(idx);
+				}
+				if (hi > 0xffff) {
+					// supplementary characters start with a lead surrogate
+					UChar32 lead_lo = U16_LEAD(std::max(lo, 0x10000));
+					for (UChar32 c = lead_lo; c <= U16_LEAD(hi); ++c) {
+						if (unit_rules[c].empty()
+								|| unit_rules[c].back() != idx) {
+							unit_rules[c].push_back(idx);
+						}
+					}
+				}
+			}
+		} else {
+			fallback_rules_.push_back(idx);
+		}
+		shapes_.push_back(shape);
+	}
+	// code units with the same candidate rules share a class
+	std::map<std::vector<int>, unsigned short> classes;
+	class_rules_.clear();
+	class_rules_.push_back(std::vector<int>());
+	classes[class_rules_[0]] = 0;
+	char_class_.resize(0x10000);
+	for (int c = 0; c < 0x10000; ++c) {
+		std::map<std::vector<int>, unsigned short>::iterator i;
+		i = classes.find(unit_rules[c]);
+		if (i == classes.end()) {
+			unsigned short cls = class_rules_.size();
+			class_rules_.push_back(unit_rules[c]);
+			i = classes.insert(std::make_pair(unit_rules[c], cls)).first;
+		}
+		char_class_[c] = i->second;
+	}
+}
+
+void PrefilterIcuSegmenter::compute_breaks(const UnicodeString& str,
+		int from, int to)
+{
+	to -= from;
+	length_ = to;
+	owner_.assign(std::max(to, 0), -1);
+	done_.assign(crules_.size(), false);
+	if (to <= 0) return;
+
+	BOOST_FOREACH (int ri, fallback_rules_) {
+		const CompiledRule& cr = crules_[ri];
+		UErrorCode ue = U_ZERO_ERROR;
+		int i = 0;
+		cr.matcher->reset(str);
+		while (cr.matcher->find(i, ue)) {
+			UErrorCode status = U_ZERO_ERROR;
+			int n = cr.matcher->end(1, status) - from;
+			if (n >= 0) {
+				if (n < to) {
+					claim(n, ri);
+				} else {
+					break;
+				}
+			}
+			i = cr.matcher->start(status) + 1;
+		}
+	}
+
+	for (size_t ri = 0; ri < crules_.size(); ++ri) {
+		crules_[ri].matcher->reset(str);
+	}
+	const UChar* buf = str.getBuffer();
+	const int len = str.length();
+	// breaks are never before the match start, so matches starting past
+	// the region are of no interest
+	const int end = std::min(len, from + to);
+	for (int s = 0; s < end; ++s) {
+		if (U16_IS_TRAIL(buf[s]) && s > 0 && U16_IS_LEAD(buf[s - 1])) {
+			continue;
+		}
+		const std::vector<int>& candidates = class_rules_[char_class_[buf[s]]];
+		BOOST_FOREACH (int ri, candidates) {
+			if (done_[ri] || !shape_matches(shapes_[ri], buf, len, s)) {
+				continue;
+			}
+			RegexMatcher& m = *crules_[ri].matcher;
+			UErrorCode status = U_ZERO_ERROR;
+			if (m.lookingAt(s, status)) {
+				int n = m.end(1, status) - from;
+				if (n >= to) {
+					done_[ri] = true;
+				} else if (n >= 0) {
+					claim(n, ri);
+				}
+			}
+		}
+	}
+}
+
+std::vector<bool> PrefilterIcuSegmenter::get_break_mask() const
+{
+	std::vector<bool> breaks(length_);
+	for (size_t i = 0; i < owner_.size(); ++i) {
+		if (owner_[i] >= 0) {
+			breaks[i] = crules_[owner_[i]].breaks;
+		}
+	}
+	return breaks;
+}
+
+std::vector<int> PrefilterIcuSegmenter::get_break_positions() const
+{
+	std::vector<int> breaks;
+	for (size_t i = 0; i < owner_.size(); ++i) {
+		if (owner_[i] >= 0 && crules_[owner_[i]].breaks) {
+			breaks.push_back(i);
+		}
+	}
+	return breaks;
+}
+
 
 #ifdef HAVE_BOOST_REGEX
 NaiveBoostSegmenter::NaiveBoostSegmenter()
@@ -23,6 +23,7 @@ or FITNESS FOR A PARTICULAR PURPOSE.
 #include <boost/utility.hpp>
 
 #include <unicode/regex.h>
+#include <unicode/uniset.h>
 
 #include <map>
 #include <vector>
@@ -77,14 +78,14 @@ public:
 	 * for break positions in the from..to range used in the previous
 	 * compute_breaks call.
 	 */
-	std::vector<bool> get_break_mask() const;
+	virtual std::vector<bool> get_break_mask() const;
 
 	/**
 	 * Break positions accessor -- returns a (sorted) vector of the
 	 * positions where breaks were detected in the previous
 	 * compute_breaks call.
 	 */
-	std::vector<int> get_break_positions() const;
+	virtual std::vector<int> get_break_positions() const;
 
 	/**
 	 * Factory for getting segmenters in a general way
@@ -156,6 +157,79 @@ private:
 	std::vector<RegexMatcher*> nobreak_back_;
 };
 
+/**
+ * A segmenter giving the same breaks as NaiveIcuSegmenter in a single pass
+ * over the string instead of one pass per rule.
+ *
+ * When the rules are loaded, the beginning of each rule pattern is
+ * examined for the sets of characters that every match has at its first
+ * few positions. The first sets of all rules are combined into one table
+ * mapping a character to the rules that can start there. The string is
+ * then scanned once, and a rule's regex is only tried at positions where
+ * the following characters fit all of its sets. Rules whose beginning is
+ * not understood (e.g. case-insensitive or anchored ones) are matched
+ * over the whole string as in NaiveIcuSegmenter.
+ *
+ * Breaks are kept in a flat buffer holding the first rule matching at
+ * each position, rather than in the break map.
+ */
+class PrefilterIcuSegmenter : public Segmenter
+{
+public:
+	/// Constructor
+	PrefilterIcuSegmenter();
+
+	/// Destructor
+	~PrefilterIcuSegmenter();
+
+	/// Segmenter override.
+	void load_rules(const std::vector<Rule>& rules);
+
+	/// Segmenter override.
+	virtual void compute_breaks(const UnicodeString& str, int from,
+			int to);
+
+	/// Segmenter override.
+	std::vector<bool> get_break_mask() const;
+
+	/// Segmenter override.
+	std::vector<int> get_break_positions() const;
+
+	/// Number of rules that are matched over the whole string
+	size_t fallback_rule_count() const {
+		return fallback_rules_.size();
+	}
+
+private:
+	/// Mark a break candidate of a rule, earlier rules take precedence
+	void claim(int pos, int rule) {
+		if (owner_[pos] < 0 || owner_[pos] > rule) {
+			owner_[pos] = rule;
+		}
+	}
+
+	/// the compiled rules, in the original order
+	std::vector<CompiledRule> crules_;
+
+	/// sets of characters at the first positions of matches of each rule
+	std::vector< std::vector<UnicodeSet> > shapes_;
+
+	/// rules that could not be indexed by their start character
+	std::vector<int> fallback_rules_;
+
+	/// start character class of each UTF-16 code unit
+	std::vector<unsigned short> char_class_;
+
+	/// indexed rules, in order, that may start with a character class
+	std::vector< std::vector<int> > class_rules_;
+
+	/// first rule matching at each position of the processed region
+	std::vector<int> owner_;
+
+	/// per-rule flag set once a rule went past the processed region
+	std::vector<bool> done_;
+};
+
 #ifdef HAVE_BOOST_REGEX
 /**
  * A segmenter using Boost regular expressions and the same approach
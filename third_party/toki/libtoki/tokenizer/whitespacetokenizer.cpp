@@ -74,8 +74,13 @@ namespace Toki {
 				rules = d.get_rules_for_lang(srx_lang);
 			}
 			//std::cerr << "SRX: " << rules.size() << " rules active\n";
-			boost::shared_ptr<Srx::Segmenter> segm =
-					boost::make_shared<Srx::NaiveIcuSegmenter>();
+			std::string engine = cfg.get("srx_engine", "icu");
+			boost::shared_ptr<Srx::Segmenter> segm(
+					Srx::Segmenter::get_segmenter_by_name(engine));
+			if (!segm) {
+				std::cerr << "Bad SRX engine:" << engine << "\n";
+				segm = boost::make_shared<Srx::NaiveIcuSegmenter>();
+			}
 			segm->load_rules(rules);
 			int window = cfg.get("srx_window", 10000);
 			int margin = cfg.get("srx_margin", 100);
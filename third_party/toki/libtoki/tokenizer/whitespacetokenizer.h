@@ -50,6 +50,10 @@ namespace Toki {
 		 * - srx_language - language to use with the SRX, determines which
 		 *                  rules will be used. The default empty value is
 		 *                  likely not going to work well.
+		 * - srx_engine - SRX segmenter implementation, see
+		 *                Srx::Segmenter::get_segmenter_by_name. Defaults
+		 *                to "icu", "icu-prefilter" gives the same breaks
+		 *                faster.
 		 * - srx_window - SRX performance tuning parameter, segmentation
 		 *                wrapper "window" parameter, see Srx::SourceWrapper
 		 * - srx_margin - SRX performance tuning parameter, segmentation
@@ -24,6 +24,7 @@ or FITNESS FOR A PARTICULAR PURPOSE.
 
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <boost/foreach.hpp>
 #include <boost/test/unit_test.hpp>
 
@@ -73,6 +74,14 @@ BOOST_AUTO_TEST_CASE( simple )
 
 	BOOST_CHECK_EQUAL_COLLECTIONS(tb, tbe, breaks.begin(), breaks.end());
 
+	Toki::Srx::PrefilterIcuSegmenter pre;
+	pre.load_rules(d.get_all_rules());
+
+	pre.compute_breaks(UnicodeString::fromUTF8(t), 0, t.size());
+	breaks = pre.get_break_positions();
+
+	BOOST_CHECK_EQUAL_COLLECTIONS(tb, tbe, breaks.begin(), breaks.end());
+
 #ifdef HAVE_BOOST_REGEX
 	// test only if build with boost.regex support
 	Toki::Srx::NaiveBoostSegmenter boo;
@@ -138,6 +147,72 @@ BOOST_AUTO_TEST_CASE( variable_window )
 
 }
 
+namespace {
+	std::vector<int> wrapped_breaks(const UnicodeString& us,
+			const boost::shared_ptr<Toki::Srx::Segmenter>& segm,
+			int window, int margin)
+	{
+		boost::shared_ptr<Toki::UnicodeIcuStringWrapper> isw;
+		isw.reset(new Toki::UnicodeIcuStringWrapper(us));
+		Toki::Srx::SourceWrapper srx(isw, segm, window, margin);
+		std::vector<int> breaks;
+		int i = 0;
+		while (srx.has_more_chars()) {
+			if (srx.peek_begins_sentence()) {
+				breaks.push_back(i);
+			}
+			++i;
+			srx.get_next_char();
+		}
+		return breaks;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( prefilter_variable_window )
+{
+	Toki::Srx::Document d;
+	std::string s = data_dir + "/one.srx";
+	std::ifstream ifs(s.c_str());
+	d.load(ifs);
+	boost::shared_ptr<Toki::Srx::Segmenter> segm(new Toki::Srx::PrefilterIcuSegmenter);
+	segm->load_rules(d.get_all_rules());
+
+	UnicodeString us = UnicodeString::fromUTF8(t);
+	for (int m = 4; m < 15; ++m) {
+		for(int w = 40; w > 0; --w) {
+			std::vector<int> breaks = wrapped_breaks(us, segm, w, m);
+			BOOST_REQUIRE_EQUAL_COLLECTIONS(tb, tbe, breaks.begin(), breaks.end());
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( prefilter_same_as_naive )
+{
+	Toki::Srx::Document d;
+	std::string s = data_dir + "/../config/segment.srx";
+	std::ifstream ifs(s.c_str());
+	d.load(ifs);
+	std::vector<Toki::Srx::Rule> rules = d.get_rules_for_lang("pl_two");
+	BOOST_REQUIRE(!rules.empty());
+	boost::shared_ptr<Toki::Srx::Segmenter> naive(new Toki::Srx::NaiveIcuSegmenter);
+	naive->load_rules(rules);
+	boost::shared_ptr<Toki::Srx::Segmenter> pre(new Toki::Srx::PrefilterIcuSegmenter);
+	pre->load_rules(rules);
+
+	const char* files[] = {"w01.txt", "w02.txt", "c01.txt", "k15.txt"};
+	BOOST_FOREACH(const char* f, files) {
+		std::string fn = data_dir + "/large/" + f;
+		std::ifstream tfs(fn.c_str());
+		std::string text((std::istreambuf_iterator<char>(tfs)),
+				std::istreambuf_iterator<char>());
+		BOOST_REQUIRE(!text.empty());
+		UnicodeString us = UnicodeString::fromUTF8(text);
+		std::vector<int> a = wrapped_breaks(us, naive, 1000, 100);
+		std::vector<int> b = wrapped_breaks(us, pre, 1000, 100);
+		BOOST_CHECK_MESSAGE(!a.empty(), "No breaks in " << f);
+		BOOST_CHECK_EQUAL_COLLECTIONS(a.begin(), a.end(), b.begin(), b.end());
+	}
+}
 
 BOOST_AUTO_TEST_CASE( sentence )
 {
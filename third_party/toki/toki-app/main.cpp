@@ -92,7 +92,7 @@ int main(int argc, char** argv)
 			("lang,l", value(&srx_lang)->default_value("pl"),
 			 "SRX language selection")
 			("srx-mode", value(&srx_mode)->default_value("icu"),
-			 "SRX mode selection")
+			 "SRX mode selection (icu, icu-hxo, icu-prefilter)")
 			("stats,s", value(&stats)->default_value(false)->zero_tokens(),
 			 "Display tokenization stats (token count) at end")
 			("no-output", value(&no_output)->default_value(false)->zero_tokens(),
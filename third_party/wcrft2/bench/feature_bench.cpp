@@ -0,0 +1,207 @@
+/* This file is part of WCRFT
+  Copyright (C) 2014 Radosław Warzocha, Adam Radziszewski.
+  WCRFT is free software; you can redistribute and/or modify it
+  under the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 3 of the License, or (at your option)
+  any later version.
+
+  WCRFT is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.
+
+  See the LICENCE and COPYING files for more details
+ */
+
+/**
+ * @file feature_bench.cpp
+ * @brief Benchmark of feature extraction feeding the CRF classifiers.
+ *
+ * Compares the former way of feeding classifiers (values of each token
+ * computed for each layer, converted to strings, joined with tabs and
+ * split again by CRF++) with SentenceFeatures. Only feature extraction
+ * and feeding are measured, sentences are neither decoded nor
+ * disambiguated, so both ways see the same input at each layer.
+ */
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+#include <libcorpus2/tagsetmanager.h>
+#include <libwccl/sentencecontext.h>
+
+#include <libwcrft/classify.h>
+#include <libwcrft/config.h>
+#include <libwcrft/corpusio.h>
+#include <libwcrft/layers.h>
+#include <libwcrft/sentencefeatures.h>
+
+typedef boost::shared_ptr<Corpus2::Sentence> SentencePtr;
+typedef std::map<std::string, Wcrft::CRFTaggerPtr> Classifiers;
+
+const std::string USAGE = "Usage: wcrft-feature-bench CONFIG CORPUS [FORMAT [ROUNDS [MODEL_DIR]]]\n\
+\n\
+Measures the speed of feature extraction on an analysed corpus\n\
+(default format: ccl, rounds: 5). If a trained model is found, features\n\
+are also fed to the CRF classifiers (without decoding).\n";
+
+/// Former way: strings built per token and layer, joined and split again.
+void feed_joined(const Wcrft::Layers& layers, Classifiers& classifiers,
+				 SentencePtr sentence, const Corpus2::Tagset& tagset)
+{
+	BOOST_FOREACH(const Wcrft::LayerPtr& layer, layers.get_layers()) {
+		Wcrft::CRFTaggerPtr crf = classifiers[layer->get_attribute_name()];
+		if(crf)
+			crf->clear();
+		Wccl::SentenceContext context = Wccl::SentenceContext(sentence);
+		for(unsigned int tok_id = 0; tok_id < sentence->size(); ++tok_id) {
+			context.set_position(tok_id);
+			Wcrft::fun_op_ptr_v operators = layer->get_attribute_operators();
+			std::vector<std::string> values;
+			BOOST_FOREACH(const Wcrft::fun_op_ptr_t& op, operators) {
+				values.push_back(op->base_apply(context)->to_compact_string(tagset));
+			}
+			std::string instance = boost::algorithm::join(values, "\t");
+			if(crf)
+				crf->add(instance.c_str());
+		}
+	}
+}
+
+/// Current way: SentenceFeatures feeding classifier columns.
+void feed_columns(const Wcrft::Layers& layers, Classifiers& classifiers,
+				  Wcrft::SentenceFeatures& features, SentencePtr sentence,
+				  const Corpus2::Tagset& tagset)
+{
+	features.start_sentence(layers, sentence);
+	BOOST_FOREACH(const Wcrft::LayerPtr& layer, layers.get_layers()) {
+		Wcrft::CRFTaggerPtr crf = classifiers[layer->get_attribute_name()];
+		if(crf)
+			crf->clear();
+		features.compute_layer(*layer, tagset);
+		const size_t num_features = layer->get_feature_ids().size();
+		for(size_t tok_id = 0; tok_id < sentence->size(); ++tok_id) {
+			const char** columns = features.token_columns(*layer, tok_id);
+			if(crf)
+				crf->add(num_features, columns);
+		}
+	}
+}
+
+/// Check that both ways give the same values, return number of differences.
+size_t count_differences(const Wcrft::Layers& layers,
+						 const std::vector<SentencePtr>& sentences,
+						 const Corpus2::Tagset& tagset)
+{
+	size_t differences = 0;
+	Wcrft::SentenceFeatures features;
+	BOOST_FOREACH(const SentencePtr& sentence, sentences) {
+		features.start_sentence(layers, sentence);
+		BOOST_FOREACH(const Wcrft::LayerPtr& layer, layers.get_layers()) {
+			features.compute_layer(*layer, tagset);
+			Wccl::SentenceContext context = Wccl::SentenceContext(sentence);
+			const Wcrft::fun_op_ptr_v& operators = layer->get_attribute_operators();
+			for(size_t tok_id = 0; tok_id < sentence->size(); ++tok_id) {
+				context.set_position(tok_id);
+				const char** columns = features.token_columns(*layer, tok_id);
+				for(size_t i = 0; i < operators.size(); ++i) {
+					// columns hold values escaped the way CRF++ gets them
+					std::string expected =
+							operators[i]->base_apply(context)->to_compact_string(tagset);
+					Wcrft::escape_separators(expected);
+					if(expected != columns[i])
+						++differences;
+				}
+			}
+		}
+	}
+	return differences;
+}
+
+void report(const std::string& name, size_t tokens, clock_t start, clock_t end)
+{
+	const double seconds = static_cast<double>(end - start) / CLOCKS_PER_SEC;
+	std::cout << name << ": " << tokens << " tokens in " << seconds << " s";
+	if(seconds > 0)
+		std::cout << ", " << static_cast<size_t>(tokens / seconds) << " tokens/s";
+	std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 3) {
+		std::cerr << USAGE;
+		return EXIT_FAILURE;
+	}
+	const std::string config_name = argv[1];
+	const std::string corpus_path = argv[2];
+	const std::string format = argc > 3 ? argv[3] : "ccl";
+	const int rounds = argc > 4 ? boost::lexical_cast<int>(argv[4]) : 5;
+	const std::string model_dir = argc > 5 ? argv[5] : "";
+
+	try {
+		Wcrft::WcrftConfig conf(config_name, model_dir);
+		const Corpus2::Tagset& tagset = Corpus2::get_named_tagset(
+					conf.get_config_section_option<std::string>(
+						Wcrft::CONFIG_S_GLOBAL, Wcrft::CONFIG_O_TAGSET));
+		Wcrft::Layers layers(conf, tagset);
+
+		std::vector<Wcrft::CRFModelPtr> models;
+		Classifiers classifiers;
+		BOOST_FOREACH(const Wcrft::LayerPtr& layer, layers.get_layers()) {
+			const std::string attr_name = layer->get_attribute_name();
+			Wcrft::CRFModelPtr model = Wcrft::load_classifier_model(attr_name, conf);
+			models.push_back(model);
+			classifiers[attr_name] = Wcrft::create_classifier(model);
+		}
+
+		std::vector<SentencePtr> sentences;
+		size_t tokens = 0;
+		boost::shared_ptr<Corpus2::TokenReader> reader =
+				Wcrft::get_reader(corpus_path, format, tagset);
+		while(SentencePtr sentence = reader->get_next_sentence()) {
+			tokens += sentence->size();
+			sentences.push_back(sentence);
+		}
+
+		std::cout << sentences.size() << " sentences, " << tokens << " tokens, "
+				  << layers.get_layers().size() << " layers, "
+				  << layers.get_features().size() << " distinct features" << std::endl;
+
+		const size_t differences = count_differences(layers, sentences, tagset);
+		if(differences > 0) {
+			std::cerr << "Error: " << differences << " feature values differ" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		clock_t start = clock();
+		for(int round = 0; round < rounds; ++round) {
+			BOOST_FOREACH(const SentencePtr& sentence, sentences) {
+				feed_joined(layers, classifiers, sentence, tagset);
+			}
+		}
+		report("joined strings", tokens * rounds, start, clock());
+
+		Wcrft::SentenceFeatures features;
+		start = clock();
+		for(int round = 0; round < rounds; ++round) {
+			BOOST_FOREACH(const SentencePtr& sentence, sentences) {
+				feed_columns(layers, classifiers, features, sentence, tagset);
+			}
+		}
+		report("sentence features", tokens * rounds, start, clock());
+	} catch(PwrNlp::PwrNlpError& e) {
+		std::cerr << "Error: " << e.info() << std::endl;
+		return EXIT_FAILURE;
+	} catch(std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
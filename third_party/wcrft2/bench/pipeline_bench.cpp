@@ -0,0 +1,187 @@
+/* This file is part of WCRFT
+  Copyright (C) 2014 Radosław Warzocha, Adam Radziszewski.
+  WCRFT is free software; you can redistribute and/or modify it
+  under the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 3 of the License, or (at your option)
+  any later version.
+
+  WCRFT is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.
+
+  See the LICENCE and COPYING files for more details
+ */
+
+/**
+ * @file pipeline_bench.cpp
+ * @brief End-to-end benchmark of the tagging pipeline and of its stages.
+ *
+ * The corpus is first read (and analysed by MACA for TXT and PREMORPH
+ * input), tagged and written to CCL as separate steps, each over the
+ * output of the previous one kept in memory. Then the whole pipeline is
+ * run the way wcrft-app runs it. For each step the throughput is reported,
+ * for the tagging steps also the per-stage timings gathered by the tagger,
+ * and at the end the peak memory use of the process.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <libcorpus2/io/writer.h>
+#include <libmaca/util/sentenceanalyser.h>
+#include <libpwrutils/stagetimer.h>
+
+#include <libwcrft/config.h>
+#include <libwcrft/corpusio.h>
+#include <libwcrft/tagger.h>
+
+typedef boost::shared_ptr<Corpus2::Chunk> ChunkPtr;
+
+const std::string USAGE = "Usage: wcrft-pipeline-bench CONFIG CORPUS [FORMAT [ROUNDS [MODEL_DIR [JSON]]]]\n\
+\n\
+Measures the speed of tagging CORPUS (default format: premorph, rounds: 3)\n\
+into CCL, of the whole pipeline and of reading, tagging and writing alone.\n\
+If JSON is given, the per-stage timings of the whole pipeline are saved\n\
+there for comparing runs.\n";
+
+void report(const std::string& name, size_t tokens, boost::uint64_t microseconds)
+{
+	const double seconds = microseconds / 1e6;
+	std::cout << name << ": " << tokens << " tokens in " << seconds << " s";
+	if(seconds > 0)
+		std::cout << ", " << static_cast<size_t>(tokens / seconds) << " tokens/s";
+	std::cout << ", peak memory " << PwrNlp::peak_memory_kb() << " kB" << std::endl;
+}
+
+bool is_maca_format(const std::string& format)
+{
+	return format == Wcrft::WCRFT_PLAIN_TEXT_FORMAT ||
+		   format == Wcrft::WCRFT_PLAIN_TEXT_FORMAT_ALT ||
+		   format == Wcrft::WCRFT_PREMORPH_TEXT_FORMAT;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 3) {
+		std::cerr << USAGE;
+		return EXIT_FAILURE;
+	}
+	const std::string config_name = argv[1];
+	const std::string corpus_path = argv[2];
+	const std::string format = argc > 3 ? argv[3] : "premorph";
+	const int rounds = argc > 4 ? boost::lexical_cast<int>(argv[4]) : 3;
+	const std::string model_dir = argc > 5 ? argv[5] : "";
+	const std::string json_path = argc > 6 ? argv[6] : "";
+
+	try {
+		std::ifstream corpus_stream(corpus_path.c_str());
+		if(!corpus_stream) {
+			std::cerr << "Error: cannot open " << corpus_path << std::endl;
+			return EXIT_FAILURE;
+		}
+		const std::string corpus((std::istreambuf_iterator<char>(corpus_stream)),
+								 std::istreambuf_iterator<char>());
+
+		Wcrft::WcrftConfig conf(config_name, model_dir);
+		const bool guess_unknown = conf.get_config_section_option<bool>(
+					Wcrft::CONFIG_S_UNKNOWN, Wcrft::CONFIG_O_UNKGUESS, false);
+
+		boost::uint64_t start = PwrNlp::monotonic_microseconds();
+		Wcrft::Tagger tagger(config_name, model_dir);
+		tagger.load_model();
+		std::cout << "model loaded in "
+				  << (PwrNlp::monotonic_microseconds() - start) / 1e6 << " s, peak memory "
+				  << PwrNlp::peak_memory_kb() << " kB" << std::endl;
+
+		// reading (and analysis) alone
+		boost::shared_ptr<Maca::SentenceAnalyser> analyser;
+		PwrNlp::StageProfile read_stages;
+		if(is_maca_format(format)) {
+			analyser = Maca::SentenceAnalyser::create_from_named_config(
+						tagger.get_maca_config());
+			analyser->set_profile(&read_stages);
+		}
+		std::vector<ChunkPtr> chunks;
+		size_t tokens = 0;
+		start = PwrNlp::monotonic_microseconds();
+		for(int round = 0; round < rounds; ++round) {
+			chunks.clear();
+			tokens = 0;
+			std::istringstream input(corpus);
+			boost::shared_ptr<Corpus2::TokenReader> reader = analyser
+					? Wcrft::get_reader(input, format, tagger.get_tagset(), analyser)
+					: Wcrft::get_reader(input, format, tagger.get_tagset());
+			while(ChunkPtr chunk = reader->get_next_chunk()) {
+				BOOST_FOREACH(const Corpus2::Sentence::Ptr& s, chunk->sentences()) {
+					tokens += s->size();
+				}
+				chunks.push_back(chunk);
+			}
+		}
+		report("read", tokens * rounds, PwrNlp::monotonic_microseconds() - start);
+		if(analyser)
+			read_stages.dump(std::cout);
+
+		// tagging alone, on copies of the read chunks
+		std::vector<ChunkPtr> tagged;
+		boost::uint64_t tagging_us = 0;
+		for(int round = 0; round < rounds; ++round) {
+			tagged.clear();
+			BOOST_FOREACH(const ChunkPtr& chunk, chunks) {
+				tagged.push_back(chunk->clone_shared());
+			}
+			start = PwrNlp::monotonic_microseconds();
+			BOOST_FOREACH(const ChunkPtr& chunk, tagged) {
+				tagger.tag_paragraph(chunk, false, guess_unknown);
+			}
+			tagging_us += PwrNlp::monotonic_microseconds() - start;
+		}
+		report("tag", tokens * rounds, tagging_us);
+		tagger.get_statistics().stages.dump(std::cout);
+
+		// writing alone
+		start = PwrNlp::monotonic_microseconds();
+		for(int round = 0; round < rounds; ++round) {
+			std::ostringstream output;
+			boost::shared_ptr<Corpus2::TokenWriter> writer =
+					Wcrft::get_writer(output, "ccl", tagger.get_tagset());
+			BOOST_FOREACH(const ChunkPtr& chunk, tagged) {
+				writer->write_chunk(*chunk);
+			}
+			writer->finish();
+		}
+		report("write", tokens * rounds, PwrNlp::monotonic_microseconds() - start);
+
+		// the whole pipeline
+		Wcrft::Statistics pipeline_stats;
+		start = PwrNlp::monotonic_microseconds();
+		for(int round = 0; round < rounds; ++round) {
+			std::istringstream input(corpus);
+			std::ostringstream output;
+			tagger.tag_input(input, format, output, "ccl");
+			pipeline_stats.merge(tagger.get_statistics());
+		}
+		report("pipeline", tokens * rounds, PwrNlp::monotonic_microseconds() - start);
+		pipeline_stats.stages.dump(std::cout);
+
+		if(!json_path.empty()) {
+			std::ofstream json(json_path.c_str());
+			pipeline_stats.write_json(json);
+			json << std::endl;
+		}
+	} catch(PwrNlp::PwrNlpError& e) {
+		std::cerr << "Error: " << e.info() << std::endl;
+		return EXIT_FAILURE;
+	} catch(std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
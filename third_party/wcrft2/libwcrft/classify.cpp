@@ -15,9 +15,12 @@
 #include <cstdlib>
 #include <iostream>
 
+#include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
+#include <boost/thread/tss.hpp>
 
 #include "classify.h"
 #include "corpusio.h"
@@ -26,26 +29,82 @@ namespace Wcrft {
 
 namespace details {
 	const std::string DATA_SEP = "\t";
+
+/**
+ * Unbuffered stream buffer writing to the buffer set for the calling
+ * thread, or to the original buffer of the stream if none is set.
+ */
+class ThreadStreambuf : public std::streambuf
+{
+public:
+	explicit ThreadStreambuf(std::streambuf* original)
+		: original_(original), target_(&keep_target) {}
+
+	std::streambuf* original() const {
+		return original_;
+	}
+
+	void set_target(std::streambuf* target) {
+		target_.reset(target);
+	}
+
+protected:
+	int_type overflow(int_type c) {
+		if(traits_type::eq_int_type(c, traits_type::eof()))
+			return traits_type::not_eof(c);
+		return current()->sputc(traits_type::to_char_type(c));
+	}
+
+	std::streamsize xsputn(const char* s, std::streamsize n) {
+		return current()->sputn(s, n);
+	}
+
+	int sync() {
+		return current()->pubsync();
+	}
+
+private:
+	/// targets are owned by the threads that set them
+	static void keep_target(std::streambuf*) {}
+
+	std::streambuf* current() {
+		std::streambuf* target = target_.get();
+		return target ? target : original_;
+	}
+
+	std::streambuf* original_;
+	boost::thread_specific_ptr<std::streambuf> target_;
+};
 }
 
-CRFTaggerPtr load_classifier(std::string attribute_name, const WcrftConfig& tagger_conf)
+CRFModelPtr load_classifier_model(std::string attribute_name, const WcrftConfig& tagger_conf)
 {
 	std::string crf_filename = tagger_conf.get_model_filename(
 				CONFIG_EXT_CR, attribute_name);
 	boost::filesystem::path crf_path(crf_filename);
 
-	CRFPP::Tagger *tagger;
+	CRFPP::Model *model;
 	if(boost::filesystem::is_regular_file(crf_path)) {
 		std::string options = "-m " + crf_filename;
-		tagger = CRFPP::createTagger(options.c_str());
-		return boost::shared_ptr<CRFPP::Tagger>(tagger);
+		model = CRFPP::createModel(options.c_str());
+		if(!model)
+			throw WcrftError("Cannot load CRF model " + crf_filename + ": "
+							 + CRFPP::getTaggerError());
+		return boost::shared_ptr<CRFPP::Model>(model);
 	} else {
 		// there's no trained model for this attr, return NULL
-		boost::shared_ptr<CRFPP::Tagger> nullish;
+		boost::shared_ptr<CRFPP::Model> nullish;
 		return nullish;
 	}
 }
 
+CRFTaggerPtr create_classifier(CRFModelPtr model)
+{
+	if(!model)
+		return CRFTaggerPtr();
+	return boost::shared_ptr<CRFPP::Tagger>(model->createTagger());
+}
+
 void classifier_open_sentence(CRFTaggerPtr crf_tagger)
 {
 	crf_tagger->clear();
@@ -55,10 +114,9 @@ void classifier_close_sentence(CRFTaggerPtr crf_tagger)
 	crf_tagger->parse();
 }
 
-void eat_token(CRFTaggerPtr crf_tagger, std::vector<std::string> featured_vals)
+void eat_token(CRFTaggerPtr crf_tagger, size_t num_values, const char** featured_vals)
 {
-	std::string instance = boost::algorithm::join(featured_vals, details::DATA_SEP);
-	crf_tagger->add(instance.c_str());
+	crf_tagger->add(num_values, featured_vals);
 }
 
 std::string classify_token(CRFTaggerPtr crf_tagger, int token_id)
@@ -66,6 +124,20 @@ std::string classify_token(CRFTaggerPtr crf_tagger, int token_id)
 	return crf_tagger->y2(token_id);
 }
 
+size_t classify_token_id(CRFTaggerPtr crf_tagger, int token_id)
+{
+	return crf_tagger->y(token_id);
+}
+
+std::vector<Corpus2::Tag> get_label_masks(CRFTaggerPtr crf_tagger, const Corpus2::Tagset& tagset)
+{
+	std::vector<Corpus2::Tag> masks;
+	for(size_t label_id = 0; label_id < crf_tagger->ysize(); ++label_id) {
+		masks.push_back(text2mask(tagset, crf_tagger->yname(label_id)));
+	}
+	return masks;
+}
+
 TrainingFiles open_training_files(WcrftConfig& config, boost::shared_ptr<Layers> layers)
 {
 	TrainingFiles training_files;
@@ -89,33 +161,96 @@ void close_training_files(TrainingFiles& training_files)
 	}
 }
 
-void train_classifier_and_save(const std::string attribute_name, const WcrftConfig& tagger_conf)
+void train_classifier_and_save(const std::string attribute_name, const WcrftConfig& tagger_conf,
+							   TrainingLog* log)
 {
 	const std::string tr_filename = tagger_conf.get_model_filename(CONFIG_EXT_DATA, attribute_name);
 	const std::string cr_filename = tagger_conf.get_model_filename(CONFIG_EXT_CR, attribute_name);
 	const std::string cr_template_filename = tagger_conf.get_config_filename(CONFIG_EXT_TEXT, attribute_name);
 	const std::string crf_opts = tagger_conf.get_config_section_option<std::string>(CONFIG_S_CLASSIFIER, CONFIG_O_PARAMS);
 
-	const std::string log_filename = tagger_conf.get_model_filename(CONFIG_EXT_LOG);
-	const std::string args[] = {"crf_learn", cr_template_filename, tr_filename, cr_filename};
-	const std::string command = boost::algorithm::join(args, " ") + " " + crf_opts;
-	const std::string redir_command = command + " >> " + log_filename + " 2>&1";
+	std::vector<std::string> args;
+	args.push_back("crf_learn");
+	std::vector<std::string> opts;
+	boost::algorithm::split(opts, crf_opts, boost::algorithm::is_space(),
+							boost::algorithm::token_compress_on);
+	BOOST_FOREACH(const std::string& opt, opts) {
+		if(!opt.empty())
+			args.push_back(opt);
+	}
+	args.push_back(cr_template_filename);
+	args.push_back(tr_filename);
+	args.push_back(cr_filename);
+
+	// crfpp_learn parses the arguments the way crf_learn does, without
+	// modifying them
+	std::vector<char*> argv;
+	BOOST_FOREACH(const std::string& arg, args) {
+		argv.push_back(const_cast<char*>(arg.c_str()));
+	}
+	const std::string command = boost::algorithm::join(args, " ");
+
+	const std::string log_filename = tagger_conf.get_model_filename(CONFIG_EXT_LOG, attribute_name);
+	std::ofstream log_file;
+	if(log) {
+		log_file.open(log_filename.c_str(), std::ios::out | std::ios::app);
+		if(!log_file)
+			throw WcrftError("Unable to open log file: " + log_filename);
+		log_file << command << std::endl;
+		log->set_thread_log(log_file.rdbuf());
+	}
+	int retval;
+	try {
+		retval = crfpp_learn(static_cast<int>(argv.size()), &argv[0]);
+	} catch(...) {
+		if(log)
+			log->set_thread_log(NULL);
+		throw;
+	}
+	if(log) {
+		log_file.flush();
+		log->set_thread_log(NULL);
+	}
 
-	int retval = system(redir_command.c_str());
 	if(retval != 0) {
+		const std::string where = log ? log_filename : "CRF++ messages above";
 		const std::string message = "CRF classifier training failed! "
-									"Check crf_learn.log for more info.\n"
-									"Call: " + command + "\n";
+									"Check " + where + " for more info.\n"
+									"Arguments: " + command + "\n";
 		throw WcrftError(message);
 	}
 }
 
-void write_example_to_file(boost::shared_ptr<std::ofstream> file,
-						   std::vector<std::string> feat_vals,
-						   std::string class_label)
+TrainingLog::TrainingLog()
+	: cout_buf_(new details::ThreadStreambuf(std::cout.rdbuf()))
+	, cerr_buf_(new details::ThreadStreambuf(std::cerr.rdbuf()))
+{
+	std::cout.flush();
+	std::cout.rdbuf(cout_buf_.get());
+	std::cerr.rdbuf(cerr_buf_.get());
+}
+
+TrainingLog::~TrainingLog()
 {
-	(*file) << boost::algorithm::join(feat_vals, details::DATA_SEP)
-			<< details::DATA_SEP << class_label << std::endl;
+	std::cout.flush();
+	std::cout.rdbuf(cout_buf_->original());
+	std::cerr.rdbuf(cerr_buf_->original());
+}
+
+void TrainingLog::set_thread_log(std::streambuf* buf)
+{
+	cout_buf_->set_target(buf);
+	cerr_buf_->set_target(buf);
+}
+
+void write_example_to_file(std::ostream& file,
+						   size_t num_values, const char** feat_vals,
+						   const std::string& class_label)
+{
+	for(size_t i = 0; i < num_values; ++i) {
+		file << feat_vals[i] << details::DATA_SEP;
+	}
+	file << class_label << '\n';
 }
 
 }
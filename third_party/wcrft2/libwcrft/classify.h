@@ -21,29 +21,47 @@
 #define WCRFT_CLASSIFY_H
 
 #include <fstream>
+#include <vector>
 
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <crfpp.h>
 
+#include <libcorpus2/tag.h>
+#include <libcorpus2/tagset.h>
+
 #include "config.h"
 #include "layers.h"
 
 namespace Wcrft {
 
+typedef boost::shared_ptr<CRFPP::Model> CRFModelPtr;
 typedef boost::shared_ptr<CRFPP::Tagger> CRFTaggerPtr;
 
 /**
- * @brief Loads trained classifier (CRFPP tagger) for given attribute.
+ * @brief Loads trained classifier model (CRFPP model) for given attribute.
  *
- * Loads trained classifier (CRFPP tagger) for given attribute from model directory stored 
+ * Loads trained classifier model for given attribute from model directory stored
  * in @c tagger_conf. File with classifier data should be named @a attribute_name @c .cr.
+ * The model holds the weights only and may be shared by many classifiers
+ * (see create_classifier), also ones used concurrently.
  *
- * @param attribute_name Attribute for which the tagger should be loaded.
+ * @param attribute_name Attribute for which the model should be loaded.
  * @param tagger_conf
- * @return Loaded CRF tagger. If no trained model file for given attribute was
+ * @return Loaded CRF model. If no trained model file for given attribute was
  * found, NULL is returned.
  */
-CRFTaggerPtr load_classifier(std::string attribute_name, const WcrftConfig& tagger_conf);
+CRFModelPtr load_classifier_model(std::string attribute_name, const WcrftConfig& tagger_conf);
+
+/**
+ * @brief Creates classifier (CRFPP tagger) using given loaded model.
+ *
+ * The classifier keeps its own decoding state, so each thread needs its own
+ * classifier. The model must outlive the classifier.
+ *
+ * @return CRF tagger or NULL if @a model is NULL.
+ */
+CRFTaggerPtr create_classifier(CRFModelPtr model);
 
 /// @brief Prepares CRF tagger (classifier) for eating a sentence-long list of feature vectors
 void classifier_open_sentence(CRFTaggerPtr crf_tagger);
@@ -51,12 +69,29 @@ void classifier_open_sentence(CRFTaggerPtr crf_tagger);
 /// @brief Tells the classifier that feeding is over.
 void classifier_close_sentence(CRFTaggerPtr crf_tagger);
 
-/// @brief Feeds CRF tagger (classifier) with feature values for token, allowing it to classify it.
-void eat_token(CRFTaggerPtr crf_tagger, std::vector<std::string> featured_vals);
+/**
+ * @brief Feeds CRF tagger (classifier) with feature values for token, allowing it to classify it.
+ *
+ * Values are passed as separate columns, so they don't need to be joined
+ * into a single line that CRF++ would split again.
+ */
+void eat_token(CRFTaggerPtr crf_tagger, size_t num_values, const char** featured_vals);
 
 /// @brief Returns CRF tagger (classifier) decision. You need to feed classifier with sentence first.
 std::string classify_token(CRFTaggerPtr crf_tagger, int token_id);
 
+/**
+ * @brief Returns index of the CRF tagger (classifier) decision among its
+ * labels (see get_label_masks). You need to feed classifier with sentence first.
+ */
+size_t classify_token_id(CRFTaggerPtr crf_tagger, int token_id);
+
+/**
+ * @brief Returns attribute value masks corresponding to all the labels known
+ * to the classifier, indexed by label index.
+ */
+std::vector<Corpus2::Tag> get_label_masks(CRFTaggerPtr crf_tagger, const Corpus2::Tagset& tagset);
+
 typedef std::map<std::string, boost::shared_ptr<std::ofstream> > TrainingFiles;
 /// @brief Opens training file for every attribute (layer).
 TrainingFiles open_training_files(WcrftConfig& config, boost::shared_ptr<Layers> layers);
@@ -64,13 +99,55 @@ TrainingFiles open_training_files(WcrftConfig& config, boost::shared_ptr<Layers>
 /// @brief Closes training files given in its first parameter.
 void close_training_files(TrainingFiles& training_files);
 
-/// @brief Train a CRF classifier for the given attr_name. The trained model is saved to files.
-void train_classifier_and_save(const std::string attribute_name, const WcrftConfig& config);
+namespace details {
+	class ThreadStreambuf;
+}
+
+/**
+ * @brief Passes what training threads write to std::cout and std::cerr
+ * to their own logs, for the lifetime of the object.
+ *
+ * CRF++ reports training progress on std::cout and errors on std::cerr.
+ * While a TrainingLog exists, the buffers of both streams are replaced,
+ * so that the output of a thread that has set its log goes to that log
+ * and the output of other threads goes to the streams as before. It
+ * should be created before the training threads start and destroyed
+ * after they end.
+ */
+class TrainingLog {
+public:
+	TrainingLog();
+	~TrainingLog();
+
+	/// Send std::cout and std::cerr output of the calling thread to buf,
+	/// or back to the streams if buf is NULL.
+	void set_thread_log(std::streambuf* buf);
+
+private:
+	TrainingLog(const TrainingLog&);
+	TrainingLog& operator=(const TrainingLog&);
+
+	boost::scoped_ptr<details::ThreadStreambuf> cout_buf_;
+	boost::scoped_ptr<details::ThreadStreambuf> cerr_buf_;
+};
+
+/**
+ * @brief Train a CRF classifier for the given attr_name. The trained model is saved to files.
+ *
+ * CRF++ training is run in process, with the options given in the config
+ * (the same as would be passed to crf_learn). Classifiers of different
+ * attributes may be trained concurrently. If log is given, the CRF++
+ * command line and messages are appended to the attribute's log in the
+ * model dir (e.g. nkjp_e2-CLASS.log), otherwise they go to std::cout and
+ * std::cerr.
+ */
+void train_classifier_and_save(const std::string attribute_name, const WcrftConfig& config,
+							   TrainingLog* log = NULL);
 
-/// @brief Writes single example in simple tab-separated format to training file.
-void write_example_to_file(boost::shared_ptr<std::ofstream> file,
-						   std::vector<std::string> feat_vals,
-						   std::string class_label);
+/// @brief Writes single example in simple tab-separated format to training data.
+void write_example_to_file(std::ostream& file,
+						   size_t num_values, const char** feat_vals,
+						   const std::string& class_label);
 
 }
 
@@ -36,6 +36,7 @@ const std::string CONFIG_S_USER = "user";
 const std::string CONFIG_O_VERBOSE = "verbose";
 const std::string CONFIG_O_PARA = "paragraphs"; // read paragraph-by-paragraph
 const std::string CONFIG_O_AMBOUT = "ambiguity"; // preserve all tags at output
+const std::string CONFIG_O_THREADS = "threads"; // tagging threads, default: 1
 
 
 // global section with tagset-related definitions
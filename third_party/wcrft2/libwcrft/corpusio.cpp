@@ -64,6 +64,19 @@ boost::shared_ptr<Corpus2::TokenReader> get_reader(
 		return Corpus2::TokenReader::create_stream_reader(input_format, tagset, input_stream);
 }
 
+boost::shared_ptr<Corpus2::TokenReader> get_reader(
+		std::istream& input_stream, const std::string& input_format,
+		const Corpus2::Tagset& tagset,
+		boost::shared_ptr<Maca::SentenceAnalyser> sentence_analyser)
+{
+	if (input_format.compare(WCRFT_PLAIN_TEXT_FORMAT) == 0 || input_format.compare(WCRFT_PLAIN_TEXT_FORMAT_ALT) == 0)
+		return boost::make_shared<Maca::TextReader>(boost::ref(input_stream), sentence_analyser);
+	else if (input_format.compare(WCRFT_PREMORPH_TEXT_FORMAT) == 0)
+		return boost::make_shared<Maca::PremorphReader>(boost::ref(input_stream), sentence_analyser);
+	else
+		return Corpus2::TokenReader::create_stream_reader(input_format, tagset, input_stream);
+}
+
 boost::shared_ptr<Corpus2::TokenWriter> get_writer(
 		const std::string& output_path, const std::string& output_format,
 		const Corpus2::Tagset& tagset)
@@ -29,6 +29,10 @@
 
 #include "config.h"
 
+namespace Maca {
+class SentenceAnalyser;
+}
+
 namespace Wcrft {
 
 const std::string FORMAT_HELP =
@@ -72,6 +76,28 @@ boost::shared_ptr<Corpus2::TokenReader> get_reader(
 		const Corpus2::Tagset& tagset, const std::string& maca_config = "");
 
 
+/**
+ * @brief Get @c Corpus2::TokenReader that reads from stream given in the first
+ * parameter using an already created MACA analyser for TXT and PREMORPH input.
+ *
+ * The analyser is only reset between paragraphs, so one instance may serve
+ * many subsequent readers, sparing the cost of loading MACA configuration
+ * and morphological dictionaries each time.
+ *
+ * @param input_stream Stream to read from
+ * @param input_format See
+ * <a href="http://nlp.pwr.wroc.pl/redmine/projects/wcrft/wiki/User_guide#Output-formats">
+ * User guide </a> for help on input/output formats
+ * @param tagset
+ * @param sentence_analyser MACA analyser to be used for TXT and PREMORPH
+ * input (ignored for other formats).
+ */
+boost::shared_ptr<Corpus2::TokenReader> get_reader(
+		std::istream& input_stream, const std::string& input_format,
+		const Corpus2::Tagset& tagset,
+		boost::shared_ptr<Maca::SentenceAnalyser> sentence_analyser);
+
+
 /**
  * @brief Get @c Corpus2::TokenWriter that writes to file given in the first parameter.
  * If filename is empty, writes to stdout.
@@ -12,7 +12,13 @@
   See the LICENCE and COPYING files for more details
  */
 
+#include <algorithm>
+#include <cctype>
+#include <set>
+
 #include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
 
 #include <libcorpus2/tagging.h>
 #include <libwccl/ops/opsequence.h>
@@ -47,12 +53,55 @@ Layers::Layers(const WcrftConfig& tagger_conf, const Corpus2::Tagset &tagset)
 			attribute_tag = Corpus2::get_attribute_mask(tagset, attribute_name);
 
 		fun_op_ptr_v attribute_operators = this->get_wccl_operators(wccl_file, attribute_name);
+		std::vector<size_t> feature_ids = this->get_feature_ids_(attribute_operators, tagset);
 
-		LayerPtr layer = boost::make_shared<Layer>(attribute_name, attribute_tag, attribute_operators);
+		LayerPtr layer = boost::make_shared<Layer>(
+					attribute_name, attribute_tag, attribute_operators, feature_ids);
 		this->layers_.push_back(layer);
 	}
 }
 
+std::vector<size_t> Layers::get_feature_ids_(const fun_op_ptr_v& operators,
+											 const Corpus2::Tagset& tagset)
+{
+	std::vector<size_t> feature_ids;
+	BOOST_FOREACH(const fun_op_ptr_t& op, operators) {
+		fun_op_ptr_v::const_iterator found =
+				std::find(features_.begin(), features_.end(), op);
+		if(found == features_.end()) {
+			feature_ids.push_back(features_.size());
+			features_.push_back(op);
+			orth_only_.push_back(is_orth_only_operator(*op, tagset));
+		} else {
+			feature_ids.push_back(found - features_.begin());
+		}
+	}
+	return feature_ids;
+}
+
+boost::shared_ptr<Layers> Layers::clone() const
+{
+	boost::shared_ptr<Layers> copy(new Layers());
+	copy->orth_only_ = orth_only_;
+	BOOST_FOREACH(const fun_op_ptr_t& op, features_) {
+		copy->features_.push_back(op->clone_clean_ptr());
+	}
+	BOOST_FOREACH(const LayerPtr& layer, layers_) {
+		fun_op_ptr_v operators_copy;
+		BOOST_FOREACH(size_t feature_id, layer->get_feature_ids()) {
+			operators_copy.push_back(copy->features_[feature_id]);
+		}
+		copy->layers_.push_back(boost::make_shared<Layer>(
+				layer->get_attribute_name(), layer->get_attribute_tag(),
+				operators_copy, layer->get_feature_ids()));
+	}
+	if(tag_rules_) {
+		// TagRule copies get their own variables
+		copy->tag_rules_ = boost::make_shared<Wccl::TagRuleSequence>(*tag_rules_);
+	}
+	return copy;
+}
+
 Layers::WcclFilePtr Layers::parse_wccl_file_(const WcrftConfig& tagger_conf, const Corpus2::Tagset &tagset)
 {
 	std::string wccl_file_path =
@@ -74,7 +123,9 @@ fun_op_ptr_v Layers::get_section_ops_(WcclFilePtr wccl_file, std::string section
 	std::vector<fun_op_ptr_t> operators;
 
 	if(wccl_file->has_untyped_section(section_name)) {
-		Wccl::UntypedOpSequence section = wccl_file->get_untyped_section(section_name);
+		// taken by reference, so that default section operators are the
+		// same objects in every layer (a copy would clone them)
+		Wccl::UntypedOpSequence& section = wccl_file->get_untyped_section(section_name);
 
 		for(unsigned int op_id = 0;op_id < section.size();++op_id) {
 			fun_op_ptr_t pointer = section.get_ptr(op_id);
@@ -86,4 +137,42 @@ fun_op_ptr_v Layers::get_section_ops_(WcclFilePtr wccl_file, std::string section
 	return operators;
 }
 
+bool is_orth_only_operator(const Wccl::FunctionalOperator& op, const Corpus2::Tagset& tagset)
+{
+	// WCCL functions and constants that don't look at token interpretations
+	static const char* safe_names[] = {
+		"orth", "affix", "lower", "upper", "regex",
+		"and", "or", "nor", "not", "if", "equal", "in", "inter", "empty",
+		"intersection", "union", "inside", "outside", "llook", "rlook",
+		"only", "atleast", "skip", "setvar", "getvar", "const", "relpos",
+		"begin", "end", "nowhere", "True", "False"
+	};
+	static const std::set<std::string> safe(
+				safe_names, safe_names + sizeof(safe_names) / sizeof(safe_names[0]));
+
+	const std::string text = op.to_string(tagset);
+	size_t i = 0;
+	while(i < text.size()) {
+		const char c = text[i];
+		if(c == '"') {
+			// skip string literal
+			for(++i; i < text.size() && text[i] != '"'; ++i)
+				if(text[i] == '\\')
+					++i;
+			++i;
+		} else if(c == '$') {
+			// skip variable reference, e.g. $s:Name or $Pos
+			for(++i; i < text.size() && (isalnum(text[i]) || text[i] == '_' || text[i] == ':'); ++i);
+		} else if(isalpha(c) || c == '_') {
+			size_t begin = i;
+			for(; i < text.size() && (isalnum(text[i]) || text[i] == '_'); ++i);
+			if(safe.find(text.substr(begin, i - begin)) == safe.end())
+				return false;
+		} else {
+			++i;
+		}
+	}
+	return true;
+}
+
 }
@@ -40,8 +40,10 @@ class Layer {
 
 public:
 	/// Creates Layer instance and sets instance fields.
-	Layer(const std::string attr_name, const Corpus2::Tag attr_tag, const fun_op_ptr_v& attr_operators)
-	: attribute_name_(attr_name), attribute_tag_(attr_tag), attribute_operators_(attr_operators)
+	Layer(const std::string attr_name, const Corpus2::Tag attr_tag, const fun_op_ptr_v& attr_operators,
+		  const std::vector<size_t>& feature_ids = std::vector<size_t>())
+	: attribute_name_(attr_name), attribute_tag_(attr_tag), attribute_operators_(attr_operators),
+	  feature_ids_(feature_ids)
 	{}
 
 	/// Returns this layer attribute name.
@@ -62,10 +64,20 @@ public:
 		return this->attribute_operators_;
 	}
 
+	/**
+	 * Returns indices of layer operators in the feature table of the
+	 * owning @c Layers (see Layers::get_features), in operator order.
+	 */
+	inline const std::vector<size_t>& get_feature_ids() const
+	{
+		return this->feature_ids_;
+	}
+
 private:
 	const std::string attribute_name_;
 	const Corpus2::Tag attribute_tag_;
 	const fun_op_ptr_v attribute_operators_;
+	const std::vector<size_t> feature_ids_;
 };
 
 typedef boost::shared_ptr<Layer> LayerPtr;
@@ -91,7 +103,7 @@ public:
 	Layers(const WcrftConfig& tagger_conf, const Corpus2::Tagset& tagset);
 
 	/// Returns collection of layers (one for every attribute)
-	inline std::vector<LayerPtr> get_layers()
+	inline const std::vector<LayerPtr>& get_layers() const
 	{
 		return this->layers_;
 	}
@@ -102,15 +114,58 @@ public:
 		return this->tag_rules_;
 	}
 
+	/**
+	 * Returns feature table: all distinct operators used by the layers
+	 * (operators of the default section are used by every layer but
+	 * appear here once).
+	 */
+	inline const fun_op_ptr_v& get_features() const
+	{
+		return this->features_;
+	}
+
+	/**
+	 * Returns whether value of the feature with given index depends only
+	 * on token orths, hence does not change when sentence is being
+	 * disambiguated and may be computed once for all layers.
+	 */
+	inline bool is_orth_only_feature(size_t feature_id) const
+	{
+		return this->orth_only_[feature_id];
+	}
+
+	/**
+	 * Returns a copy of all the layers and tag rules that may be used
+	 * concurrently with the original: WCCL operators and tag rules keep
+	 * their variables and may not be evaluated concurrently, their copies
+	 * may.
+	 */
+	boost::shared_ptr<Layers> clone() const;
+
 private:
+	Layers() {}
+
 	WcclFilePtr parse_wccl_file_(const WcrftConfig &tagger_conf, const Corpus2::Tagset& tagset);
 	fun_op_ptr_v get_wccl_operators(WcclFilePtr wccl_file, std::string attr_name);
 	fun_op_ptr_v get_section_ops_(WcclFilePtr wccl_file, std::string section_name);
+	std::vector<size_t> get_feature_ids_(const fun_op_ptr_v& operators, const Corpus2::Tagset& tagset);
 
 	std::vector<LayerPtr> layers_;
 	boost::shared_ptr<Wccl::TagRuleSequence> tag_rules_;
+
+	fun_op_ptr_v features_;
+	std::vector<bool> orth_only_;
 };
 
+/**
+ * @brief Tells if WCCL operator reads nothing but token orths.
+ *
+ * The check is made on the textual form of the operator and is
+ * conservative: any function or symbol that is not known to be independent
+ * of token interpretations makes the answer negative.
+ */
+bool is_orth_only_operator(const Wccl::FunctionalOperator& op, const Corpus2::Tagset& tagset);
+
 }
 
 #endif // WCRFT_LAYER_H
@@ -0,0 +1,107 @@
+/* This file is part of WCRFT
+  Copyright (C) 2014 Radosław Warzocha, Adam Radziszewski.
+  WCRFT is free software; you can redistribute and/or modify it
+  under the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 3 of the License, or (at your option)
+  any later version.
+
+  WCRFT is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.
+
+  See the LICENCE and COPYING files for more details
+ */
+
+#include "pipeline.h"
+
+namespace Wcrft {
+
+TaggingJobQueue::TaggingJobQueue(size_t max_pending)
+	: max_pending_(max_pending > 0 ? max_pending : 1),
+	  next_seq_(0), next_write_(0),
+	  input_finished_(false), aborted_(false)
+{
+}
+
+bool TaggingJobQueue::add(TaggingJob job)
+{
+	boost::mutex::scoped_lock lock(mutex_);
+	while(!aborted_ && next_seq_ - next_write_ >= max_pending_)
+		changed_.wait(lock);
+	if(aborted_)
+		return false;
+
+	job.seq = next_seq_++;
+	todo_.push_back(job);
+	changed_.notify_all();
+	return true;
+}
+
+void TaggingJobQueue::finish_input()
+{
+	boost::mutex::scoped_lock lock(mutex_);
+	input_finished_ = true;
+	changed_.notify_all();
+}
+
+bool TaggingJobQueue::take(TaggingJob& job)
+{
+	boost::mutex::scoped_lock lock(mutex_);
+	while(!aborted_ && todo_.empty() && !input_finished_)
+		changed_.wait(lock);
+	if(aborted_ || todo_.empty())
+		return false;
+
+	job = todo_.front();
+	todo_.pop_front();
+	return true;
+}
+
+void TaggingJobQueue::done(const TaggingJob& job)
+{
+	boost::mutex::scoped_lock lock(mutex_);
+	finished_[job.seq] = job;
+	changed_.notify_all();
+}
+
+bool TaggingJobQueue::next_done(TaggingJob& job)
+{
+	boost::mutex::scoped_lock lock(mutex_);
+	while(!aborted_ && finished_.find(next_write_) == finished_.end()
+		  && !(input_finished_ && next_write_ == next_seq_))
+		changed_.wait(lock);
+
+	std::map<size_t, TaggingJob>::iterator it = finished_.find(next_write_);
+	if(aborted_ || it == finished_.end())
+		return false;
+
+	job = it->second;
+	finished_.erase(it);
+	++next_write_;
+	changed_.notify_all();
+	return true;
+}
+
+void TaggingJobQueue::abort(const std::string& reason)
+{
+	boost::mutex::scoped_lock lock(mutex_);
+	if(!aborted_) {
+		aborted_ = true;
+		abort_reason_ = reason;
+	}
+	changed_.notify_all();
+}
+
+bool TaggingJobQueue::is_aborted()
+{
+	boost::mutex::scoped_lock lock(mutex_);
+	return aborted_;
+}
+
+std::string TaggingJobQueue::abort_reason()
+{
+	boost::mutex::scoped_lock lock(mutex_);
+	return abort_reason_;
+}
+
+}
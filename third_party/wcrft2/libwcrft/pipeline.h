@@ -0,0 +1,112 @@
+/* This file is part of WCRFT
+  Copyright (C) 2014 Radosław Warzocha, Adam Radziszewski.
+  WCRFT is free software; you can redistribute and/or modify it
+  under the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 3 of the License, or (at your option)
+  any later version.
+
+  WCRFT is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.
+
+  See the LICENCE and COPYING files for more details
+ */
+
+/**
+ * @file pipeline.h
+ * @brief Synchronisation of parallel reading, tagging and writing.
+ */
+
+#ifndef WCRFT_PIPELINE_H
+#define WCRFT_PIPELINE_H
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <libcorpus2/chunk.h>
+#include <libcorpus2/sentence.h>
+
+namespace Wcrft {
+
+/**
+ * @brief Unit of work passed through the parallel tagging pipeline.
+ *
+ * Holds either a paragraph or a sentence (depending on whether paragraphs
+ * are being processed) and its position in the input. When generating
+ * training data, the job also carries the examples generated from its
+ * sentence, to be written out in input order.
+ */
+struct TaggingJob {
+	TaggingJob() : seq(0) {}
+
+	size_t seq;
+	boost::shared_ptr<Corpus2::Chunk> paragraph;
+	boost::shared_ptr<Corpus2::Sentence> sentence;
+
+	/// training examples of the sentence, one block per layer (in layer order)
+	std::vector<std::string> examples;
+	/// attributes for which the sentence gave training data
+	std::set<std::string> attributes_met;
+};
+
+/**
+ * @brief Queue of tagging jobs shared by the reader, the workers and the
+ * writer.
+ *
+ * The reader adds jobs in input order, workers take and tag them in any
+ * order and the writer gets tagged jobs back in input order. At most
+ * @c max_pending jobs may be read but not yet written, which bounds the
+ * memory used when a single job takes long to tag.
+ *
+ * Any stage may abort the processing (e.g. on error); all blocked calls
+ * return false then.
+ */
+class TaggingJobQueue {
+public:
+	explicit TaggingJobQueue(size_t max_pending);
+
+	/// Reader: add job, blocking while too many jobs are pending.
+	bool add(TaggingJob job);
+
+	/// Reader: tell there will be no more jobs.
+	void finish_input();
+
+	/// Worker: take a job to be tagged, false when there are no more jobs.
+	bool take(TaggingJob& job);
+
+	/// Worker: hand back the tagged job.
+	void done(const TaggingJob& job);
+
+	/// Writer: get next tagged job in input order, false when all written.
+	bool next_done(TaggingJob& job);
+
+	/// Stop all stages, remembering the first reason given.
+	void abort(const std::string& reason);
+
+	bool is_aborted();
+
+	std::string abort_reason();
+
+private:
+	const size_t max_pending_;
+
+	std::deque<TaggingJob> todo_;
+	std::map<size_t, TaggingJob> finished_;
+	size_t next_seq_, next_write_;
+	bool input_finished_, aborted_;
+	std::string abort_reason_;
+
+	boost::mutex mutex_;
+	boost::condition_variable changed_;
+};
+
+}
+
+#endif // WCRFT_PIPELINE_H
@@ -0,0 +1,91 @@
+/* This file is part of WCRFT
+  Copyright (C) 2014 Radosław Warzocha, Adam Radziszewski.
+  WCRFT is free software; you can redistribute and/or modify it
+  under the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 3 of the License, or (at your option)
+  any later version.
+
+  WCRFT is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.
+
+  See the LICENCE and COPYING files for more details
+ */
+
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/foreach.hpp>
+
+#include <libwccl/sentencecontext.h>
+
+#include "sentencefeatures.h"
+
+namespace Wcrft {
+
+namespace details {
+
+/// characters splitting CRF++ columns (space, tab) or examples (line breaks)
+const char* const SEPARATORS = " \t\n\r";
+
+}
+
+void escape_separators(std::string& value)
+{
+	boost::algorithm::replace_all(value, " ", "\\u0020");
+	boost::algorithm::replace_all(value, "\t", "\\u0009");
+	boost::algorithm::replace_all(value, "\n", "\\u000a");
+	boost::algorithm::replace_all(value, "\r", "\\u000d");
+}
+
+SentenceFeatures::SentenceFeatures()
+	: layers_(NULL), num_tokens_(0), num_features_(0)
+{
+}
+
+void SentenceFeatures::start_sentence(const Layers& layers,
+									  boost::shared_ptr<Corpus2::Sentence> sentence)
+{
+	this->layers_ = &layers;
+	this->sentence_ = sentence;
+	this->num_tokens_ = sentence->size();
+	this->num_features_ = layers.get_features().size();
+
+	const size_t needed = this->num_tokens_ * this->num_features_;
+	if(this->values_.size() < needed)
+		this->values_.resize(needed);
+	this->computed_.assign(this->num_features_, false);
+}
+
+void SentenceFeatures::compute_layer(const Layer& layer, const Corpus2::Tagset& tagset)
+{
+	const fun_op_ptr_v& features = this->layers_->get_features();
+	Wccl::SentenceContext context(this->sentence_);
+
+	BOOST_FOREACH(size_t feature_id, layer.get_feature_ids()) {
+		if(this->computed_[feature_id]
+		   && this->layers_->is_orth_only_feature(feature_id))
+			continue;
+
+		const fun_op_ptr_t& op = features[feature_id];
+		for(size_t pos = 0; pos < this->num_tokens_; ++pos) {
+			context.set_position(pos);
+			// assignment keeps the capacity of the string from previous use
+			std::string& value = this->value(pos, feature_id);
+			value = op->base_apply(context)->to_compact_string(tagset);
+			if(value.find_first_of(details::SEPARATORS) != std::string::npos)
+				escape_separators(value);
+		}
+		this->computed_[feature_id] = true;
+	}
+}
+
+const char** SentenceFeatures::token_columns(const Layer& layer, size_t pos)
+{
+	const std::vector<size_t>& feature_ids = layer.get_feature_ids();
+	this->columns_.resize(feature_ids.size());
+	for(size_t i = 0; i < feature_ids.size(); ++i) {
+		this->columns_[i] = this->value(pos, feature_ids[i]).c_str();
+	}
+	return this->columns_.empty() ? NULL : &this->columns_[0];
+}
+
+}
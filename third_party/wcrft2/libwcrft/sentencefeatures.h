@@ -0,0 +1,114 @@
+/* This file is part of WCRFT
+  Copyright (C) 2014 Radosław Warzocha, Adam Radziszewski.
+  WCRFT is free software; you can redistribute and/or modify it
+  under the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 3 of the License, or (at your option)
+  any later version.
+
+  WCRFT is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.
+
+  See the LICENCE and COPYING files for more details
+ */
+
+/**
+ * @file sentencefeatures.h
+ * @brief Feature extraction feeding WCCL operator values to CRF classifiers.
+ */
+
+#ifndef WCRFT_SENTENCEFEATURES_H
+#define WCRFT_SENTENCEFEATURES_H
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <libcorpus2/sentence.h>
+#include <libcorpus2/tagset.h>
+
+#include "layers.h"
+
+namespace Wcrft {
+
+/**
+ * Replace spaces, tabs and line breaks in a feature value with \\uXXXX
+ * escapes, the way WCCL escapes them in string sets, so that the value
+ * is one column both in training data (split by CRF++) and when fed to
+ * the classifier.
+ */
+void escape_separators(std::string& value);
+
+/**
+ * @brief Feature values of a sentence, computed layer by layer.
+ *
+ * Values are kept in a table indexed by token position and feature id
+ * (see Layers::get_features). Features that depend on token orths only
+ * are computed once per sentence and reused by all subsequent layers;
+ * other features are recomputed for each layer since the sentence is
+ * being disambiguated in between.
+ *
+ * Spaces, tabs and line breaks in values are escaped (as WCCL does in
+ * string sets), so that a value is always a single column, whether fed
+ * to CRF++ directly or written to training data that CRF++ splits.
+ *
+ * Value strings and column pointer buffers are kept between sentences, so
+ * once the object has seen a long enough sentence, extracting features
+ * does not allocate beyond what WCCL operators allocate themselves.
+ *
+ * The object is stateful and must not be shared between threads.
+ */
+class SentenceFeatures {
+public:
+	SentenceFeatures();
+
+	/**
+	 * @brief Start extracting features of given sentence.
+	 *
+	 * Must be called before compute_layer, after any changes to the
+	 * sentence orths (e.g. WCCL tag rules may only change interpretations).
+	 */
+	void start_sentence(const Layers& layers, boost::shared_ptr<Corpus2::Sentence> sentence);
+
+	/**
+	 * @brief Compute values of all features of the layer for each
+	 * sentence token (orth-only features computed earlier are reused).
+	 */
+	void compute_layer(const Layer& layer, const Corpus2::Tagset& tagset);
+
+	/**
+	 * @brief Return values of layer features for token at @a pos, in
+	 * layer operator order, as C strings suitable for CRFPP::Tagger::add.
+	 *
+	 * The returned array has Layer::get_feature_ids().size() items and
+	 * is valid until the next call of any non-const method.
+	 */
+	const char** token_columns(const Layer& layer, size_t pos);
+
+	/// Number of tokens in the current sentence.
+	inline size_t size() const
+	{
+		return this->num_tokens_;
+	}
+
+private:
+	inline std::string& value(size_t pos, size_t feature_id)
+	{
+		return this->values_[pos * this->num_features_ + feature_id];
+	}
+
+	const Layers* layers_;
+	boost::shared_ptr<Corpus2::Sentence> sentence_;
+	size_t num_tokens_, num_features_;
+
+	/// feature values, row per token position (only grows)
+	std::vector<std::string> values_;
+	/// whether a feature has been computed for the current sentence
+	std::vector<bool> computed_;
+	std::vector<const char*> columns_;
+};
+
+}
+
+#endif // WCRFT_SENTENCEFEATURES_H
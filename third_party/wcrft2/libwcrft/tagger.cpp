@@ -15,22 +15,140 @@
 #include <algorithm>
 #include <fstream>
 #include <map>
+#include <sstream>
 #include <vector>
 
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 #include <libcorpus2/tagging.h>
 #include <libcorpus2/tagsetmanager.h>
+#include <libmaca/util/sentenceanalyser.h>
 
 #include "config.h"
 #include "tagger.h"
 #include "corpusio.h"
+#include "pipeline.h"
 
 namespace Wcrft {
 
+namespace details {
+
+size_t count_tokens(const Corpus2::Chunk& paragraph)
+{
+	size_t tokens = 0;
+	BOOST_FOREACH(const Corpus2::Sentence::Ptr& sentence, paragraph.sentences()) {
+		tokens += sentence->size();
+	}
+	return tokens;
+}
+
+/// Worker stage of parallel tagging: tag jobs until there are no more.
+void tag_jobs(boost::shared_ptr<Tagger> worker, TaggingJobQueue& queue,
+			  bool preserve_ambiguity, bool guess_unknown)
+{
+	try {
+		TaggingJob job;
+		while(queue.take(job)) {
+			if(job.paragraph)
+				worker->tag_paragraph(job.paragraph, preserve_ambiguity, guess_unknown);
+			else
+				worker->tag_sentence(job.sentence, preserve_ambiguity, guess_unknown);
+			queue.done(job);
+		}
+	} catch(PwrNlp::PwrNlpError& e) {
+		queue.abort(e.info());
+	} catch(std::exception& e) {
+		queue.abort(e.what());
+	} catch(...) {
+		queue.abort("tagging failed");
+	}
+}
+
+/// Writer stage of parallel tagging: write tagged jobs in input order.
+void write_jobs(boost::shared_ptr<Corpus2::TokenWriter> writer, TaggingJobQueue& queue,
+				PwrNlp::StageProfile& stages)
+{
+	try {
+		PwrNlp::StageStats& write_stats = stages.stage("write");
+		TaggingJob job;
+		while(queue.next_done(job)) {
+			if(job.paragraph) {
+				PwrNlp::StageTimer timer(&write_stats, count_tokens(*job.paragraph));
+				writer->write_chunk(*job.paragraph);
+			} else {
+				PwrNlp::StageTimer timer(&write_stats, job.sentence->size());
+				writer->write_sentence(*job.sentence);
+			}
+		}
+	} catch(PwrNlp::PwrNlpError& e) {
+		queue.abort(e.info());
+	} catch(std::exception& e) {
+		queue.abort(e.what());
+	} catch(...) {
+		queue.abort("writing output failed");
+	}
+}
+
+/// Layers waiting for their classifiers to be trained, shared by training threads.
+struct TrainingQueue {
+	TrainingQueue() : next(0) {}
+
+	std::vector<std::string> attributes;
+	size_t next;
+	/// reason of the first failure, training stops when set
+	std::string error;
+	boost::mutex mutex;
+};
+
+/// Training stage: train classifiers until there are no more or one fails.
+void train_layers(TrainingQueue& queue, const WcrftConfig& config, TrainingLog& log,
+				  bool verbose)
+{
+	while(true) {
+		std::string attribute_name;
+		{
+			boost::mutex::scoped_lock lock(queue.mutex);
+			if(!queue.error.empty() || queue.next == queue.attributes.size())
+				return;
+			attribute_name = queue.attributes[queue.next++];
+		}
+
+		// whole lines, so that messages of concurrent stages don't mix
+		if(verbose)
+			std::cerr << "Training tagger for " + attribute_name + "\n";
+		try {
+			train_classifier_and_save(attribute_name, config, &log);
+		} catch(PwrNlp::PwrNlpError& e) {
+			boost::mutex::scoped_lock lock(queue.mutex);
+			if(queue.error.empty())
+				queue.error = e.info();
+			return;
+		} catch(std::exception& e) {
+			boost::mutex::scoped_lock lock(queue.mutex);
+			if(queue.error.empty())
+				queue.error = e.what();
+			return;
+		} catch(...) {
+			boost::mutex::scoped_lock lock(queue.mutex);
+			if(queue.error.empty())
+				queue.error = "training classifier for " + attribute_name + " failed";
+			return;
+		}
+		if(verbose)
+			std::cerr << "Done: " + attribute_name + "\n";
+	}
+}
+
+}
+
 Tagger::Tagger(const std::string& config_name, const std::string& model_dir)
 	: tagger_conf_(config_name, model_dir)
+	, tag_stage_(NULL), guesser_stage_(NULL), wccl_stage_(NULL)
 {
 	std::string tagset_name =
 			tagger_conf_.get_config_section_option<std::string>(
@@ -45,11 +163,20 @@ Tagger::~Tagger()
 void Tagger::load_model()
 {
 	this->layers_ = boost::make_shared<Layers>(tagger_conf_, tagset_);
+	this->model_weights_.clear();
+	this->model_.clear();
+	this->label_masks_.clear();
+	this->workers_.clear();
 	BOOST_FOREACH(const LayerPtr layer, layers_->get_layers()) {
 		const std::string attr_name = layer->get_attribute_name();
-		this->model_[attr_name] = load_classifier(attr_name, tagger_conf_);
+		this->model_weights_[attr_name] = load_classifier_model(attr_name, tagger_conf_);
+		this->model_[attr_name] = create_classifier(this->model_weights_[attr_name]);
+		if(this->model_[attr_name])
+			this->label_masks_[attr_name] = get_label_masks(this->model_[attr_name], tagset_);
 	}
 
+	this->init_layer_stages();
+
 	bool unk_guess = is_guessing_unknown();
 	if(unk_guess)
 		this->load_unknown_tags();
@@ -94,54 +221,104 @@ void Tagger::tag_input(const std::string& input_file, const std::string& input_f
 			tagger_conf_.get_config_section_option<std::string>(
 				CONFIG_S_GLOBAL, CONFIG_O_MACACFG);
 
-	TokenReaderPtr reader = get_reader(
-				input_file, input_format, this->tagset_, maca_cfg);
 	TokenWriterPtr writer = get_writer(
 				output_file, output_format, this->tagset_);
 
+	if(input_format.compare(WCRFT_PLAIN_TEXT_FORMAT) == 0 ||
+	   input_format.compare(WCRFT_PLAIN_TEXT_FORMAT_ALT) == 0 ||
+	   input_format.compare(WCRFT_PREMORPH_TEXT_FORMAT) == 0) {
+		// use the kept analyser, so that its stages are timed
+		if(input_file.empty()) {
+			this->tag_input_inner(get_reader(std::cin, input_format, this->tagset_,
+											 this->get_sentence_analyser()), writer);
+		} else {
+			std::ifstream input_stream(input_file.c_str());
+			if(!input_stream)
+				throw FileNotFound(input_file, "", "input file");
+			this->tag_input_inner(get_reader(input_stream, input_format, this->tagset_,
+											 this->get_sentence_analyser()), writer);
+		}
+		return;
+	}
+
+	TokenReaderPtr reader = get_reader(
+				input_file, input_format, this->tagset_, maca_cfg);
 	this->tag_input_inner(reader, writer);
 }
 
 void Tagger::tag_input(std::istream& input_stream, const std::string& input_format,
 					   std::ostream& output_stream, const std::string& output_format)
 {
-	const std::string maca_cfg =
-			tagger_conf_.get_config_section_option<std::string>(
-				CONFIG_S_GLOBAL, CONFIG_O_MACACFG);
-
-	TokenReaderPtr reader = get_reader(
-				input_stream, input_format, this->tagset_, maca_cfg);
+	TokenReaderPtr reader;
+	if(input_format.compare(WCRFT_PLAIN_TEXT_FORMAT) == 0 ||
+	   input_format.compare(WCRFT_PLAIN_TEXT_FORMAT_ALT) == 0 ||
+	   input_format.compare(WCRFT_PREMORPH_TEXT_FORMAT) == 0)
+		reader = get_reader(
+					input_stream, input_format, this->tagset_,
+					this->get_sentence_analyser());
+	else
+		reader = get_reader(input_stream, input_format, this->tagset_);
 	TokenWriterPtr writer = get_writer(
 				output_stream, output_format, this->tagset_);
 
 	this->tag_input_inner(reader, writer);
 }
 
+Tagger::SentenceAnalyserPtr Tagger::get_sentence_analyser()
+{
+	const std::string maca_cfg = this->get_maca_config();
+	if(!this->sentence_analyser_ || maca_cfg != this->sentence_analyser_cfg_) {
+		this->sentence_analyser_ =
+				Maca::SentenceAnalyser::create_from_named_config(maca_cfg);
+		this->sentence_analyser_->set_profile(&this->stats_.stages);
+		this->sentence_analyser_cfg_ = maca_cfg;
+	}
+	return this->sentence_analyser_;
+}
+
 void Tagger::tag_input_inner(TokenReaderPtr reader, TokenWriterPtr writer)
 {
+	const int threads = get_threads();
+	if(threads > 1) {
+		this->tag_input_parallel(reader, writer, threads);
+		return;
+	}
+
 	this->stats_.clear();
 
 	const bool preserve_ambiguity = is_preserving_ambiguity();
 	const bool guess_unknown = is_guessing_unknown();
 	const bool preserve_paragraphs = is_processing_paragraphs();
 
+	PwrNlp::StageStats& read_stats = this->stats_.stages.stage("read");
+	PwrNlp::StageStats& write_stats = this->stats_.stages.stage("write");
+
 	if(preserve_paragraphs)
 		// iterate over paragraphs, process each par sentence
 		while(true) {
+			PwrNlp::StageTimer read_timer(&read_stats);
 			ChunkPtr paragraph = reader->get_next_chunk();
 			if(!paragraph)
 				break;
+			const size_t tokens = details::count_tokens(*paragraph);
+			read_timer.set_tokens(tokens);
+			read_timer.stop();
 			this->tag_paragraph(paragraph, preserve_ambiguity, guess_unknown);
+			PwrNlp::StageTimer write_timer(&write_stats, tokens);
 			writer->write_chunk(*paragraph);
 		}
 	else
 		// iterate over sentences ignoring paragraph boundaries
 		// (whether present or not in input)
 		while(true) {
+			PwrNlp::StageTimer read_timer(&read_stats);
 			SentencePtr sentence = reader->get_next_sentence();
 			if(!sentence)
 				break;
+			read_timer.set_tokens(sentence->size());
+			read_timer.stop();
 			this->tag_sentence(sentence, preserve_ambiguity, guess_unknown);
+			PwrNlp::StageTimer write_timer(&write_stats, sentence->size());
 			writer->write_sentence(*sentence);
 		}
 
@@ -151,6 +328,114 @@ void Tagger::tag_input_inner(TokenReaderPtr reader, TokenWriterPtr writer)
 	writer->finish();
 }
 
+boost::shared_ptr<Tagger> Tagger::create_worker() const
+{
+	if(!this->layers_)
+		throw WcrftError("Tagger model must be loaded before tagging.");
+
+	boost::shared_ptr<Tagger> worker(new Tagger(*this));
+	worker->layers_ = this->layers_->clone();
+	worker->model_.clear();
+	BOOST_FOREACH(const ModelWeights::value_type& weights, this->model_weights_) {
+		worker->model_[weights.first] = create_classifier(weights.second);
+	}
+	worker->workers_.clear();
+	worker->sentence_analyser_.reset();
+	worker->features_ = SentenceFeatures();
+	worker->stats_.clear();
+	worker->init_layer_stages();
+	// progress is reported by the parent using merged statistics
+	worker->switch_verbose(false);
+	worker->set_threads(1);
+	return worker;
+}
+
+void Tagger::init_layer_stages()
+{
+	this->tag_stage_ = &this->stats_.stages.stage("tag");
+	this->guesser_stage_ = &this->stats_.stages.stage("guesser");
+	this->wccl_stage_ = &this->stats_.stages.stage("wccl");
+	this->layer_stages_.clear();
+	BOOST_FOREACH(const LayerPtr layer, layers_->get_layers()) {
+		const std::string& attribute_name = layer->get_attribute_name();
+		LayerStages stages;
+		stages.features = &this->stats_.stages.stage("features:" + attribute_name);
+		stages.crf = &this->stats_.stages.stage("crf:" + attribute_name);
+		this->layer_stages_.push_back(stages);
+	}
+}
+
+void Tagger::tag_input_parallel(TokenReaderPtr reader, TokenWriterPtr writer, int threads)
+{
+	this->stats_.clear();
+
+	const bool preserve_ambiguity = is_preserving_ambiguity();
+	const bool guess_unknown = is_guessing_unknown();
+	const bool preserve_paragraphs = is_processing_paragraphs();
+
+	if(this->workers_.size() != static_cast<size_t>(threads)) {
+		this->workers_.clear();
+		for(int i = 0; i < threads; ++i)
+			this->workers_.push_back(this->create_worker());
+	}
+	BOOST_FOREACH(boost::shared_ptr<Tagger> worker, this->workers_) {
+		worker->stats_.clear();
+	}
+
+	PwrNlp::StageStats& read_stats = this->stats_.stages.stage("read");
+	// the writer thread times its stage separately, merged when done
+	PwrNlp::StageProfile writer_stages;
+
+	TaggingJobQueue queue(4 * threads);
+	boost::thread_group stages;
+	BOOST_FOREACH(boost::shared_ptr<Tagger> worker, this->workers_) {
+		stages.create_thread(boost::bind(&details::tag_jobs, worker, boost::ref(queue),
+										 preserve_ambiguity, guess_unknown));
+	}
+	stages.create_thread(boost::bind(&details::write_jobs, writer, boost::ref(queue),
+									 boost::ref(writer_stages)));
+
+	try {
+		while(true) {
+			TaggingJob job;
+			PwrNlp::StageTimer read_timer(&read_stats);
+			if(preserve_paragraphs) {
+				job.paragraph = reader->get_next_chunk();
+				if(!job.paragraph)
+					break;
+				read_timer.set_tokens(details::count_tokens(*job.paragraph));
+			} else {
+				job.sentence = reader->get_next_sentence();
+				if(!job.sentence)
+					break;
+				read_timer.set_tokens(job.sentence->size());
+			}
+			read_timer.stop();
+			if(!queue.add(job))
+				break;
+		}
+	} catch(...) {
+		queue.abort("reading input failed");
+		stages.join_all();
+		throw;
+	}
+	queue.finish_input();
+	stages.join_all();
+
+	if(queue.is_aborted())
+		throw WcrftError(queue.abort_reason());
+
+	BOOST_FOREACH(boost::shared_ptr<Tagger> worker, this->workers_) {
+		this->stats_.merge(worker->stats_);
+	}
+	this->stats_.stages.merge(writer_stages);
+
+	if(is_verbose())
+		this->stats_.dump();
+
+	writer->finish();
+}
+
 void Tagger::tag_paragraph(ChunkPtr paragraph, bool preserve_ambiguity, bool guess_unknown)
 {
 	BOOST_FOREACH( SentencePtr sentence_ptr, paragraph->sentences() ) {
@@ -160,8 +445,11 @@ void Tagger::tag_paragraph(ChunkPtr paragraph, bool preserve_ambiguity, bool gue
 
 void Tagger::tag_sentence(SentencePtr sentence, bool preserve_ambiguity, bool guess_unknown)
 {
-	if(guess_unknown)
+	PwrNlp::StageTimer timer(this->tag_stage_, sentence->size());
+	if(guess_unknown) {
+		PwrNlp::StageTimer guesser_timer(this->guesser_stage_, sentence->size());
 		this->preprocess_unknown_tokens(sentence);
+	}
 
 	if(preserve_ambiguity) {
 		SentencePtr disambd = sentence->clone_shared();
@@ -259,13 +547,24 @@ std::set<std::string> Tagger::write_training_examples(const std::string& input_p
 			open_training_files(this->tagger_conf_, this->layers_);
 	TokenReaderPtr reader =
 			get_reader(input_path, input_format, this->tagset_);
+
+	const int threads = get_threads();
+	if(threads > 1) {
+		attributes_met = this->write_training_examples_parallel(
+					reader, training_files, threads);
+		close_training_files(training_files);
+		return attributes_met;
+	}
+
+	std::vector<std::string> examples;
 	while(true) {
 		SentencePtr sentence = reader->get_next_sentence();
 		if(!sentence)
 			break;
 
-		std::set<std::string> sentence_attrs_met = write_sentence_training_examples(sentence, training_files);
+		std::set<std::string> sentence_attrs_met = write_sentence_training_examples(sentence, examples);
 		attributes_met.insert(sentence_attrs_met.begin(), sentence_attrs_met.end());
+		this->write_examples(examples, training_files);
 
 		this->stats_.num_sentences++;
 		this->stats_.num_tokens += sentence->tokens().size();
@@ -277,8 +576,96 @@ std::set<std::string> Tagger::write_training_examples(const std::string& input_p
 	return attributes_met;
 }
 
+std::set<std::string> Tagger::write_training_examples_parallel(TokenReaderPtr reader,
+															   TrainingFiles& training_files,
+															   int threads)
+{
+	// workers are created for this training only, as layers have been
+	// set up anew for it
+	std::vector<boost::shared_ptr<Tagger> > workers;
+	for(int i = 0; i < threads; ++i)
+		workers.push_back(this->create_worker());
+
+	std::set<std::string> attributes_met;
+	TaggingJobQueue queue(4 * threads);
+	boost::thread_group stages;
+	BOOST_FOREACH(boost::shared_ptr<Tagger> worker, workers) {
+		stages.create_thread(boost::bind(&Tagger::generate_examples_jobs, worker,
+										 boost::ref(queue)));
+	}
+	stages.create_thread(boost::bind(&Tagger::write_examples_jobs, this, boost::ref(queue),
+									 boost::ref(training_files), boost::ref(attributes_met)));
+
+	try {
+		while(true) {
+			TaggingJob job;
+			job.sentence = reader->get_next_sentence();
+			if(!job.sentence)
+				break;
+
+			this->stats_.num_sentences++;
+			this->stats_.num_tokens += job.sentence->size();
+			if(this->is_verbose())
+				this->stats_.report();
+
+			if(!queue.add(job))
+				break;
+		}
+	} catch(...) {
+		queue.abort("reading training data failed");
+		stages.join_all();
+		throw;
+	}
+	queue.finish_input();
+	stages.join_all();
+
+	if(queue.is_aborted())
+		throw WcrftError(queue.abort_reason());
+
+	BOOST_FOREACH(boost::shared_ptr<Tagger> worker, workers) {
+		this->stats_.merge(worker->stats_);
+	}
+	return attributes_met;
+}
+
+void Tagger::generate_examples_jobs(TaggingJobQueue& queue)
+{
+	try {
+		TaggingJob job;
+		while(queue.take(job)) {
+			job.attributes_met = this->write_sentence_training_examples(
+						job.sentence, job.examples);
+			queue.done(job);
+		}
+	} catch(PwrNlp::PwrNlpError& e) {
+		queue.abort(e.info());
+	} catch(std::exception& e) {
+		queue.abort(e.what());
+	} catch(...) {
+		queue.abort("generating training examples failed");
+	}
+}
+
+void Tagger::write_examples_jobs(TaggingJobQueue& queue, TrainingFiles& training_files,
+								 std::set<std::string>& attributes_met)
+{
+	try {
+		TaggingJob job;
+		while(queue.next_done(job)) {
+			this->write_examples(job.examples, training_files);
+			attributes_met.insert(job.attributes_met.begin(), job.attributes_met.end());
+		}
+	} catch(PwrNlp::PwrNlpError& e) {
+		queue.abort(e.info());
+	} catch(std::exception& e) {
+		queue.abort(e.what());
+	} catch(...) {
+		queue.abort("writing training examples failed");
+	}
+}
+
 std::set<std::string> Tagger::write_sentence_training_examples(SentencePtr sentence,
-															   TrainingFiles training_files)
+															   std::vector<std::string>& examples)
 {
 	std::set<std::string> attributes_met;
 	boost::shared_ptr<Wccl::TagRuleSequence> tag_rules =
@@ -288,44 +675,41 @@ std::set<std::string> Tagger::write_sentence_training_examples(SentencePtr sente
 	if(tag_rules)
 		tag_rules->execute_once(sentence);
 
+	examples.clear();
+	this->features_.start_sentence(*layers_, sentence);
 	BOOST_FOREACH(const LayerPtr layer, layers_->get_layers()) {
-		std::string attribute_name = layer->get_attribute_name();
-		boost::shared_ptr<std::ofstream> tfile = training_files[attribute_name];
+		std::ostringstream layer_examples;
 
-		bool got_data = write_sentence_layer_examples(sentence, layer, tfile);
+		bool got_data = write_sentence_layer_examples(sentence, layer, layer_examples);
 
-		*tfile << std::endl;
+		layer_examples << '\n';
+		examples.push_back(layer_examples.str());
 		if(got_data)
-			attributes_met.insert(attribute_name);
+			attributes_met.insert(layer->get_attribute_name());
 	}
 
 	return attributes_met;
 }
 
 bool Tagger::write_sentence_layer_examples(SentencePtr sentence, const LayerPtr layer,
-										   boost::shared_ptr<std::ofstream> tfile)
+										   std::ostream& output)
 {
-	const std::string attribute_name = layer->get_attribute_name();
 	const Corpus2::Tag attribute_mask = layer->get_attribute_tag();
-	const fun_op_ptr_v attribute_ops = layer->get_attribute_operators();
+	const size_t num_features = layer->get_feature_ids().size();
 	bool got_data = false;
 
-	Wccl::SentenceContext context = Wccl::SentenceContext(sentence);
-	std::vector<Corpus2::Token*> sent_tokens = sentence->tokens();
+	this->features_.compute_layer(*layer, tagset_);
+	const std::vector<Corpus2::Token*>& sent_tokens = sentence->tokens();
 	for(unsigned int tok_id = 0;tok_id < sent_tokens.size();++tok_id) {
 		Corpus2::Token* tok = sent_tokens[tok_id];
-		context.set_position(tok_id);
 
 		Corpus2::Tag all_attr_vals = Corpus2::mask_token(*tok, attribute_mask, false);
 		Corpus2::Tag disamb_attr_vals = Corpus2::mask_token(*tok, attribute_mask, true);
 
-		std::vector<std::string> feat_vals;
-		BOOST_FOREACH(fun_op_ptr_t op, attribute_ops) {
-			std::string val = op->base_apply(context)->to_compact_string(tagset_);
-			feat_vals.push_back(val);
-		}
 		std::string class_label = mask2text(tagset_, disamb_attr_vals);
-		write_example_to_file(tfile, feat_vals, class_label);
+		write_example_to_file(output, num_features,
+							  this->features_.token_columns(*layer, tok_id),
+							  class_label);
 
 		stats_.num_evals++;
 
@@ -338,20 +722,44 @@ bool Tagger::write_sentence_layer_examples(SentencePtr sentence, const LayerPtr
 	return got_data;
 }
 
+void Tagger::write_examples(const std::vector<std::string>& examples,
+							TrainingFiles& training_files)
+{
+	const std::vector<LayerPtr>& layers = this->layers_->get_layers();
+	for(size_t i = 0; i < layers.size(); ++i) {
+		*training_files[layers[i]->get_attribute_name()] << examples[i];
+	}
+}
+
 void Tagger::train_classifiers(std::set<std::string> attributes_met)
 {
+	details::TrainingQueue queue;
 	BOOST_FOREACH(const LayerPtr layer, layers_->get_layers()) {
 		const std::string attribute_name = layer->get_attribute_name();
-
-		if(this->is_verbose())
-			std::cerr << "Training tagger for " << attribute_name << std::endl;
-
 		if(attributes_met.find(attribute_name) != attributes_met.end())
-			train_classifier_and_save(attribute_name, this->tagger_conf_);
+			queue.attributes.push_back(attribute_name);
+	}
 
-		if(this->is_verbose())
-			std::cerr << "Done\n";
+	const bool verbose = this->is_verbose();
+	const size_t threads = std::min(
+				static_cast<size_t>(std::max(get_threads(), 1)), queue.attributes.size());
+
+	// CRF++ messages of each layer go to the layer's own log
+	TrainingLog log;
+	if(threads > 1) {
+		boost::thread_group training;
+		for(size_t i = 0; i < threads; ++i) {
+			training.create_thread(boost::bind(&details::train_layers, boost::ref(queue),
+											   boost::cref(this->tagger_conf_),
+											   boost::ref(log), verbose));
+		}
+		training.join_all();
+	} else {
+		details::train_layers(queue, this->tagger_conf_, log, verbose);
 	}
+
+	if(!queue.error.empty())
+		throw WcrftError(queue.error);
 }
 
 void Tagger::load_unknown_tags()
@@ -383,6 +791,7 @@ void Tagger::preprocess_unknown_tokens(SentencePtr sentence)
 			}
 			Corpus2::Tag disamb = token->get_preferred_lexeme(this->tagset_).tag();
 
+			token->lexemes().reserve(token->lexemes().size() + this->unknown_tags_.size());
 			BOOST_FOREACH(Corpus2::Tag unknown_tag, this->unknown_tags_) {
 				if(unknown_tag != disamb)
 					token->add_lexeme(Corpus2::Lexeme(lemma, unknown_tag));
@@ -405,13 +814,19 @@ void Tagger::disambiguate_sentence(SentencePtr sentence)
 {
 	boost::shared_ptr<Wccl::TagRuleSequence> tag_rules =
 			layers_->get_tag_rules();
-	if(tag_rules && !(tag_rules->empty()))
+	if(tag_rules && !(tag_rules->empty())) {
+		PwrNlp::StageTimer timer(this->wccl_stage_, sentence->size());
 		tag_rules->execute_once(sentence);
+	}
 
-	BOOST_FOREACH(const LayerPtr layer, layers_->get_layers()) {
+	this->features_.start_sentence(*layers_, sentence);
+	const std::vector<LayerPtr>& layers = layers_->get_layers();
+	for(size_t layer_idx = 0; layer_idx < layers.size(); ++layer_idx) {
+		const LayerPtr layer = layers[layer_idx];
 		CRFTaggerPtr crf_tagger = this->model_[layer->get_attribute_name()];
 		if(crf_tagger) {
-			this->feed_tagger(crf_tagger, sentence, layer);
+			this->feed_tagger(crf_tagger, sentence, layer,
+							  this->layer_stages_[layer_idx]);
 			this->classify_sentence(crf_tagger, sentence, layer);
 		}
 	}
@@ -424,26 +839,23 @@ void Tagger::disambiguate_sentence(SentencePtr sentence)
 		this->stats_.report();
 }
 
-void Tagger::feed_tagger(CRFTaggerPtr crf_tagger, SentencePtr sentence, const LayerPtr layer)
+void Tagger::feed_tagger(CRFTaggerPtr crf_tagger, SentencePtr sentence,
+						 const LayerPtr layer, const LayerStages& stages)
 {
+	PwrNlp::StageTimer features_timer(stages.features, sentence->size());
+	// get feature values of each token and its context; values that depend
+	// on orths only are shared with preceding layers
+	this->features_.compute_layer(*layer, this->tagset_);
+	const size_t num_features = layer->get_feature_ids().size();
+	features_timer.stop();
+
+	PwrNlp::StageTimer crf_timer(stages.crf, sentence->size());
+
 	// prepare the classifier to eat a sentence-long list of feature vectors
-	Wccl::SentenceContext context = Wccl::SentenceContext(sentence);
 	classifier_open_sentence(crf_tagger);
 
 	for(unsigned int tok_id = 0; tok_id < sentence->size(); ++tok_id) {
-		context.set_position(tok_id);
-		// get feature values of token at tok_id and its context
-		std::vector<fun_op_ptr_t> operators = layer->get_attribute_operators();
-		std::vector<std::string> featured_vals;
-		for(unsigned int j = 0;j < operators.size();++j) {
-			fun_op_ptr_t op = operators[j];
-
-			if(op) {
-				std::string val = op->base_apply(context)->to_compact_string(this->tagset_);
-				featured_vals.push_back(val);
-			}
-		}
-		eat_token(crf_tagger, featured_vals);
+		eat_token(crf_tagger, num_features, this->features_.token_columns(*layer, tok_id));
 	}
 
 	// tell the classifier the feeding is over
@@ -452,11 +864,12 @@ void Tagger::feed_tagger(CRFTaggerPtr crf_tagger, SentencePtr sentence, const La
 
 void Tagger::classify_sentence(CRFTaggerPtr crf_tagger, SentencePtr sentence, const LayerPtr layer)
 {
+	const std::string& attribute_name = layer->get_attribute_name();
+	const std::vector<Corpus2::Tag>& label_masks = this->label_masks_[attribute_name];
+
 	// feeding with feature vectors is over and we'll be asking about decisions
 	// concerning each fed token
 	for(unsigned int tok_id = 0;tok_id < sentence->tokens().size();++tok_id) {
-		std::string class_label = classify_token(crf_tagger, tok_id);
-
 		bool success = false;
 
 		Corpus2::Token *token = sentence->tokens()[tok_id];
@@ -467,7 +880,8 @@ void Tagger::classify_sentence(CRFTaggerPtr crf_tagger, SentencePtr sentence, co
 		// this mask represents the value of the attribute that is predicted by
 		// the classifier; if the value encodes all possible values of the
 		// attribute, it means that no value should be given for it
-		Corpus2::Tag wanted_attribute_vals = text2mask(this->tagset_, class_label);
+		const Corpus2::Tag& wanted_attribute_vals =
+				label_masks[classify_token_id(crf_tagger, tok_id)];
 
 		if(!wanted_attribute_vals.is_null()) {
 			// will succeed if an interpretation with wanted_attribute_vals
@@ -475,9 +889,9 @@ void Tagger::classify_sentence(CRFTaggerPtr crf_tagger, SentencePtr sentence, co
 			success = Corpus2::disambiguate_equal(
 						token, all_attribute_vals, wanted_attribute_vals);
 			this->stats_.num_evals++;
-			this->stats_.layer_gets[layer->get_attribute_name()]++;
+			this->stats_.layer_gets[attribute_name]++;
 			if(not success)
-				this->stats_.layer_fails[layer->get_attribute_name()]++;
+				this->stats_.layer_fails[attribute_name]++;
 		}
 	}
 }
@@ -500,6 +914,12 @@ void Tagger::switch_paragraph_processing(bool paragraphs)
 				CONFIG_S_USER, CONFIG_O_PARA, paragraphs);
 }
 
+void Tagger::set_threads(int threads)
+{
+	tagger_conf_.set_config_section_option<int>(
+				CONFIG_S_USER, CONFIG_O_THREADS, threads);
+}
+
 void Tagger::select_preferred_tags(SentencePtr sentence)
 {
 	for(unsigned int i = 0;i < sentence->tokens().size();++i) {
@@ -551,6 +971,12 @@ bool Tagger::is_guessing_unknown()
 					CONFIG_S_UNKNOWN, CONFIG_O_UNKGUESS, false);
 }
 
+int Tagger::get_threads()
+{
+	return tagger_conf_.get_config_section_option<int>(
+				CONFIG_S_USER, CONFIG_O_THREADS, 1);
+}
+
 /*** STATISTICS ***/
 
 Statistics::Statistics()
@@ -562,6 +988,7 @@ void Statistics::clear()
 {
 	layer_gets.clear();
 	layer_fails.clear();
+	stages.clear();
 
 	this->num_tokens = 0;
 	this->num_sentences = 0;
@@ -585,6 +1012,47 @@ void Statistics::dump(std::ostream& output_stream)
 						  << gets << "/" << fails << std::endl;
 		}
 	}
+	output_stream << "Stage timings:" << std::endl;
+	this->stages.dump(output_stream);
+}
+
+void Statistics::merge(const Statistics& other)
+{
+	typedef std::map<std::string, int>::value_type LayerCount;
+	BOOST_FOREACH(const LayerCount& gets, other.layer_gets) {
+		layer_gets[gets.first] += gets.second;
+	}
+	BOOST_FOREACH(const LayerCount& fails, other.layer_fails) {
+		layer_fails[fails.first] += fails.second;
+	}
+
+	this->num_tokens += other.num_tokens;
+	this->num_sentences += other.num_sentences;
+	this->num_evals += other.num_evals;
+
+	this->stages.merge(other.stages);
+}
+
+void Statistics::write_json(std::ostream& output_stream) const
+{
+	output_stream << "{\"tokens\":" << this->num_tokens
+				  << ",\"sentences\":" << this->num_sentences
+				  << ",\"evals\":" << this->num_evals
+				  << ",\"layers\":{";
+	bool first = true;
+	typedef std::map<std::string, int>::value_type LayerCount;
+	BOOST_FOREACH(const LayerCount& gets, layer_gets) {
+		std::map<std::string, int>::const_iterator fails = layer_fails.find(gets.first);
+		if(!first)
+			output_stream << ",";
+		first = false;
+		output_stream << "\"" << gets.first << "\":{\"gets\":" << gets.second
+					  << ",\"fails\":" << (fails != layer_fails.end() ? fails->second : 0)
+					  << "}";
+	}
+	output_stream << "},\"stages\":";
+	this->stages.write_json(output_stream);
+	output_stream << ",\"peak_memory_kb\":" << PwrNlp::peak_memory_kb() << "}";
 }
 
 void Statistics::report(std::ostream& output_stream, int sents)
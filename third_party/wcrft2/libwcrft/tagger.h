@@ -25,13 +25,21 @@
 #include <libcorpus2/tagset.h>
 #include <libcorpus2/io/reader.h>
 #include <libcorpus2/io/writer.h>
+#include <libpwrutils/stagetimer.h>
 
 #include "config.h"
 #include "classify.h"
 #include "layers.h"
+#include "sentencefeatures.h"
+
+namespace Maca {
+class SentenceAnalyser;
+}
 
 namespace Wcrft {
 
+class TaggingJobQueue;
+
 /// Class for displaying tagger statistics.
 class Statistics {
 public:
@@ -58,8 +66,26 @@ public:
 	 */
 	void report(std::ostream& output_stream = std::cerr, int sents = 100);
 
+	/// Add counts gathered by @c other (e.g. by another tagging thread).
+	void merge(const Statistics& other);
+
+	/**
+	 * @brief Writes all counts and stage timings to @c output_stream
+	 * as a single JSON object.
+	 */
+	void write_json(std::ostream& output_stream) const;
+
 	std::map<std::string, int> layer_gets, layer_fails;
 	int num_tokens, num_sentences, num_evals;
+
+	/**
+	 * Wall time spent in each stage of tagging: "read" and "write" (the
+	 * reader and writer calls, "read" including "toki" and "maca" for
+	 * TXT and PREMORPH input), "guesser" (unknown word tags), "wccl" (tag
+	 * rules), "features:ATTR" and "crf:ATTR" (feature extraction and CRF++
+	 * decoding of each layer) and "tag" (the whole tag_sentence call).
+	 */
+	PwrNlp::StageProfile stages;
 };
 
 /**
@@ -85,6 +111,8 @@ private:
 	typedef boost::shared_ptr<Corpus2::Chunk> ChunkPtr;
 	typedef boost::shared_ptr<Corpus2::Sentence> SentencePtr;
 
+	typedef boost::shared_ptr<Maca::SentenceAnalyser> SentenceAnalyserPtr;
+
 public:
 	/**
 	 * @brief Creates WCRFT Tagger instance using given config name
@@ -119,6 +147,18 @@ public:
 	 * results, consider running morphological reanalysis of the training data
 	 * before training proper (consult documentation).
 	 *
+	 * With more than one thread set (see set_threads), training examples
+	 * are generated by worker threads and the classifiers of the layers are
+	 * trained concurrently. The trained model is the same as when trained
+	 * with a single thread.
+	 *
+	 * CRF++ runs in process. While the classifiers are trained, the stream
+	 * buffers of std::cout and std::cerr are replaced: CRF++ progress and
+	 * error messages of each layer are appended to its own log in the
+	 * model dir (e.g. nkjp_e2-CLASS.log), and output of other threads
+	 * passes through. Output written to the stdout or stderr file
+	 * descriptors directly (e.g. with printf) is not redirected.
+	 *
 	 * @param input_file Training corpus; should contain the interpretations
 	 *        selected as golden-standard (marked as 'disamb') but also the
 	 * 	other 'possible choices' as selected by morphological analyser.
@@ -152,6 +192,10 @@ public:
 	 * stream. Since the input is processed gradually, may be used to tag large
 	 * texts without running out of memory.
 	 *
+	 * For TXT and PREMORPH input the MACA analyser is created on first use
+	 * and kept by the tagger, so subsequent calls (e.g. when serving many
+	 * requests with one tagger instance) don't pay for loading it again.
+	 *
 	 * @param input_stream
 	 * @param input_format
 	 * @param output_stream
@@ -214,6 +258,21 @@ public:
 	 */
 	void switch_paragraph_processing(bool paragraphs);
 
+	/**
+	 * Set number of threads used to tag input with tag_input, default: 1.
+	 * With more than one thread, input is read and output written by
+	 * separate threads while paragraphs (or sentences, if paragraph
+	 * processing is switched off) are tagged by the given number of worker
+	 * threads. Output order is the same as input order. Each worker keeps
+	 * its own decoding state and copies of WCCL operators, while trained
+	 * CRF models are loaded once and shared.
+	 *
+	 * The same number of threads is used by train_and_save, both to
+	 * generate training examples and to train classifiers of the layers
+	 * (each layer trained in a single thread, unless CRF++ is given the -p
+	 * option in the config).
+	 */
+	void set_threads(int threads);
 
 
 	/**
@@ -255,9 +314,47 @@ public:
 	 */
 	const std::string get_maca_config() const;
 
+	/**
+	 * Counts and stage timings gathered by the last tag_input or
+	 * train_and_save call, or since the last of these by tag_sentence
+	 * and tag_paragraph.
+	 */
+	const Statistics& get_statistics() const
+	{
+		return stats_;
+	}
+
+	/**
+	 * Create a tagger for another thread: it shares tagset, configuration,
+	 * unknown tag list and loaded CRF models with this tagger, but has its
+	 * own copies of everything that changes while tagging, so both may
+	 * tag at the same time. The model must be loaded. The new tagger uses
+	 * one thread and is not verbose; its settings may be changed.
+	 */
+	boost::shared_ptr<Tagger> create_worker() const;
+
 private:
 	void tag_input_inner(TokenReaderPtr reader, TokenWriterPtr writer);
 
+	/**
+	 * Tag the input using a reader stage (in calling thread), @a threads
+	 * worker threads and a writer stage keeping the input order.
+	 */
+	void tag_input_parallel(TokenReaderPtr reader, TokenWriterPtr writer, int threads);
+
+	/**
+	 * Look up the timing stages of sentence tagging and of each layer in
+	 * stats_, so that tagging does not build stage names and search for
+	 * them for every sentence.
+	 */
+	void init_layer_stages();
+
+	/**
+	 * Return MACA analyser for the current MACA config, creating it
+	 * if not created yet or if the config has been overriden since.
+	 */
+	SentenceAnalyserPtr get_sentence_analyser();
+
 	typedef std::map<std::string, int> UnkTagsCount;
 	/**
 	 * Reads in_path token by token, gathers most frequent forms and stores it
@@ -296,10 +393,42 @@ private:
 	 */
 	std::set<std::string> write_training_examples(const std::string& input_path,
 												  const std::string& input_format);
+
+	/**
+	 * Generate training examples using a reader stage (in calling thread),
+	 * @a threads worker threads and a writer stage appending the examples
+	 * of each sentence to the training files in input order, so that the
+	 * files are the same as when generated in a single thread.
+	 */
+	std::set<std::string> write_training_examples_parallel(TokenReaderPtr reader,
+														   TrainingFiles& training_files,
+														   int threads);
+
+	/// Worker stage of parallel example generation.
+	void generate_examples_jobs(TaggingJobQueue& queue);
+
+	/// Writer stage of parallel example generation.
+	void write_examples_jobs(TaggingJobQueue& queue, TrainingFiles& training_files,
+							 std::set<std::string>& attributes_met);
+
+	/**
+	 * Generate training examples of the sentence for each layer, stored
+	 * in @a examples in layer order, one block per layer.
+	 * @return attributes for which the sentence gave training data
+	 */
 	std::set<std::string> write_sentence_training_examples(SentencePtr sentence,
-														   TrainingFiles training_files);
+														   std::vector<std::string>& examples);
 	bool write_sentence_layer_examples(SentencePtr sentence, const LayerPtr layer,
-									   boost::shared_ptr<std::ofstream> tfile);
+									   std::ostream& output);
+
+	/// Append examples generated for a sentence to the training files.
+	void write_examples(const std::vector<std::string>& examples,
+						TrainingFiles& training_files);
+
+	/**
+	 * Train classifiers of the layers that got training data, as many
+	 * at a time as there are threads set.
+	 */
 	void train_classifiers(std::set<std::string> attributes_met);
 
 	/**
@@ -327,7 +456,14 @@ private:
 	 */
 	void disambiguate_sentence(SentencePtr sentence);
 
-	void feed_tagger(CRFTaggerPtr crf_tagger, SentencePtr sentence, const LayerPtr layer);
+	/// timing stages of a tagging layer
+	struct LayerStages {
+		PwrNlp::StageStats* features;
+		PwrNlp::StageStats* crf;
+	};
+
+	void feed_tagger(CRFTaggerPtr crf_tagger, SentencePtr sentence,
+					 const LayerPtr layer, const LayerStages& stages);
 	void classify_sentence(CRFTaggerPtr crf_tagger, SentencePtr sentence, const LayerPtr layer);
 	void select_preferred_tags(SentencePtr sentence);
 
@@ -346,18 +482,44 @@ private:
 	/// Return if tag guessing for unknown words is turned on in the config.
 	bool is_guessing_unknown();
 
+	/// Return number of threads to be used for tagging.
+	int get_threads();
+
 	WcrftConfig tagger_conf_;
 
 	typedef std::map<std::string, CRFTaggerPtr> Model;
+	typedef std::map<std::string, CRFModelPtr> ModelWeights;
+	typedef std::map<std::string, std::vector<Corpus2::Tag> > LabelMasks;
 
 
 	Corpus2::Tagset tagset_;
 	std::vector<Corpus2::Tag> unknown_tags_;
 
 	boost::shared_ptr<Layers> layers_;
+	/// loaded CRF models, shared with worker taggers
+	ModelWeights model_weights_;
+	/// CRF taggers (decoding state) created from model_weights_
 	Model model_;
+	/// attribute value masks of CRF labels, by attribute and label index
+	LabelMasks label_masks_;
+
+	/// feature values of the sentence being tagged or used for training
+	SentenceFeatures features_;
+
+	/// taggers used by worker threads, created on first parallel tagging
+	std::vector<boost::shared_ptr<Tagger> > workers_;
+
+	SentenceAnalyserPtr sentence_analyser_;
+	std::string sentence_analyser_cfg_;
 
 	Statistics stats_;
+	/// timing stages in stats_ of each layer, in the order of layers_
+	std::vector<LayerStages> layer_stages_;
+	/// timing stages in stats_ of tagging a sentence, of guessing unknown
+	/// word tags and of WCCL tag rules, NULL until the model is loaded
+	PwrNlp::StageStats* tag_stage_;
+	PwrNlp::StageStats* guesser_stage_;
+	PwrNlp::StageStats* wccl_stage_;
 };
 
 }
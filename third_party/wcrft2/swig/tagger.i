@@ -58,6 +58,7 @@ public:
 	void switch_verbose(bool verbose);
 	void switch_preserve_ambiguity(bool ambiguity);
 	void switch_paragraph_processing(bool paragraphs);
+	void set_threads(int threads);
 
 	template<typename T>
 	inline void set_configuration_option(const std::string& option_name, T value)
@@ -0,0 +1,97 @@
+/* This file is part of WCRFT
+  Copyright (C) 2014 Radosław Warzocha, Adam Radziszewski.
+  WCRFT is free software; you can redistribute and/or modify it
+  under the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 3 of the License, or (at your option)
+  any later version.
+
+  WCRFT is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.
+
+  See the LICENCE and COPYING files for more details
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+
+#include <libwcrft/config.h>
+#include <libwcrft/tagger.h>
+
+namespace {
+
+const std::string config_path = LIBWCRFT_TEST_CONFIG_DIR "nkjp_e2.ini";
+const std::string corpus_path = LIBWCRFT_TEST_DATA_DIR "data/train.xml";
+
+/// Train the tagger using the given number of threads into a new temporary dir.
+boost::filesystem::path train(int threads)
+{
+	boost::filesystem::path model_dir =
+			boost::filesystem::temp_directory_path() /
+			boost::filesystem::unique_path("wcrft-test-%%%%-%%%%-%%%%");
+	boost::filesystem::create_directories(model_dir);
+
+	Wcrft::Tagger tagger(config_path, model_dir.string());
+	// the corpus is tiny, so rare features must not be cut off
+	tagger.set_configuration_option<std::string>("crf.params", "-a CRF-L2 -f 1");
+	tagger.set_threads(threads);
+	tagger.train_and_save(corpus_path, "xces");
+	return model_dir;
+}
+
+std::string read_file(const std::string& filename)
+{
+	std::ifstream ifs(filename.c_str(), std::ios::binary);
+	return std::string((std::istreambuf_iterator<char>(ifs)),
+					   std::istreambuf_iterator<char>());
+}
+
+void check_same_file(const std::string& expected, const std::string& actual)
+{
+	BOOST_REQUIRE_EQUAL(boost::filesystem::exists(expected),
+						boost::filesystem::exists(actual));
+	BOOST_CHECK_MESSAGE(read_file(expected) == read_file(actual),
+						actual << " differs from " << expected);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(training)
+
+BOOST_AUTO_TEST_CASE(parallel_same_as_sequential)
+{
+	const boost::filesystem::path sequential_dir = train(1);
+	const boost::filesystem::path parallel_dir = train(4);
+	const Wcrft::WcrftConfig sequential(config_path, sequential_dir.string());
+	const Wcrft::WcrftConfig parallel(config_path, parallel_dir.string());
+
+	BOOST_CHECK(boost::filesystem::exists(
+					sequential.get_model_filename(Wcrft::CONFIG_EXT_CR, "CLASS")));
+	check_same_file(sequential.get_model_filename(Wcrft::CONFIG_EXT_UNKTAGS),
+					parallel.get_model_filename(Wcrft::CONFIG_EXT_UNKTAGS));
+
+	const char* attributes[] = {"CLASS", "nmb", "cas", "gnd", "asp"};
+	BOOST_FOREACH(const char* attribute, attributes) {
+		// training data written in input order, trained models the same
+		check_same_file(sequential.get_model_filename(Wcrft::CONFIG_EXT_DATA, attribute),
+						parallel.get_model_filename(Wcrft::CONFIG_EXT_DATA, attribute));
+		check_same_file(sequential.get_model_filename(Wcrft::CONFIG_EXT_CR, attribute),
+						parallel.get_model_filename(Wcrft::CONFIG_EXT_CR, attribute));
+		// each layer logs to its own file, also when trained concurrently
+		const std::string log = read_file(
+					parallel.get_model_filename(Wcrft::CONFIG_EXT_LOG, attribute));
+		BOOST_CHECK_EQUAL(log.find("crf_learn"), 0u);
+		BOOST_CHECK_EQUAL(log.find("crf_learn", 1), std::string::npos);
+	}
+
+	boost::filesystem::remove_all(sequential_dir);
+	boost::filesystem::remove_all(parallel_dir);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
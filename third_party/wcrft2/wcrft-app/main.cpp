@@ -56,6 +56,9 @@ This may also be used to override default model dir. When training,\
 use -d to specify a directory where trained model should be saved.\n\
 \n\
 Use -O to specify output path (by default will write to stdout).\n\
+Use -o readability to output readability statistics of the text (JSON)\
+instead of the tagged text.\n\
+Use --stats-json to save the time spent in each stage of tagging (JSON).\n\
 Use - to tag stdin to stdout.\n\
 \n\
 When tagging multiple files, either give the filenames directly as arguments,\
@@ -133,8 +136,17 @@ int run_tagger(Wcrft::Tagger& tagger, Filenames input_files, const prog_opts::va
 {
 	FilenamePairs in_out_filenames = create_in_out_filenames(input_files, config);
 	tagger.load_model();
+	Wcrft::Statistics stats;
 	BOOST_FOREACH(FilenamePair io_pair, in_out_filenames) {
 		tag_one(tagger, io_pair, config);
+		stats.merge(tagger.get_statistics());
+	}
+
+	const std::string stats_file = config["stats-json"].as<std::string>();
+	if(!stats_file.empty()) {
+		std::ofstream stats_stream(stats_file.c_str());
+		stats.write_json(stats_stream);
+		stats_stream << std::endl;
 	}
 	return 0;
 }
@@ -156,6 +168,7 @@ void update_taggers_config(Wcrft::Tagger& tagger, const prog_opts::variables_map
 	tagger.switch_paragraph_processing(!var_map["sent-only"].as<bool>());
 	tagger.switch_preserve_ambiguity(var_map["ambiguity"].as<bool>());
 	tagger.switch_verbose(var_map["verbose"].as<bool>());
+	tagger.set_threads(var_map["threads"].as<int>());
 
 	std::string maca_config = var_map["maca-config"].as<std::string>();
 	if(!maca_config.empty())
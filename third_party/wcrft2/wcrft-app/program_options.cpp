@@ -38,7 +38,9 @@ prog_opts::options_description create_options_description(const std::string& des
 		("wccl-config,wc", prog_opts::value<std::string>()->default_value(""), "overrides wccl config file")
 		("ambiguity,A", prog_opts::bool_switch(), "preserve non-disamb interpretations after tagging")
 		("sent-only,S", prog_opts::bool_switch(), "read sentence-by-sentence and ignore paragraphs")
+		("threads,t", prog_opts::value<int>()->default_value(1), "number of tagging (or training) threads")
 		("verbose,v", prog_opts::bool_switch(), "verbose mode")
+		("stats-json", prog_opts::value<std::string>()->default_value(""), "write counts and per-stage timings of tagging to the given file (JSON)")
 		("train", prog_opts::bool_switch(), "train the tagger")
 		("batch", prog_opts::bool_switch(), "treat arguments as lists of paths to files")
 		("config", prog_opts::value<std::string>()->required(), "Tagger configuration file")
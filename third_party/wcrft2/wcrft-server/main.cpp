@@ -0,0 +1,169 @@
+/* This file is part of WCRFT
+  Copyright (C) 2014 Radosław Warzocha, Adam Radziszewski.
+  WCRFT is free software; you can redistribute and/or modify it
+  under the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 3 of the License, or (at your option)
+  any later version.
+
+  WCRFT is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.
+
+  See the LICENCE and COPYING files for more details
+ */
+
+/**
+ * @file main.cpp
+ * @brief Resident WCRFT tagging server.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+#include <boost/program_options.hpp>
+
+#include <libcorpus2/exception.h>
+
+#include <libwcrft/tagger.h>
+
+#include "server.h"
+
+namespace prog_opts = boost::program_options;
+
+const std::string DESCRIPTION = "wcrft-server [options] CONFIGFILE\n\
+\n\
+WCRFT, Wroclaw CRF Tagger -- tagging server\n\
+\n\
+Loads the tagger model once and serves tagging requests over HTTP, either\
+on a TCP port (--port) or on a Unix domain socket (--socket).\
+Each request is a POST whose body (or \"file\" field of a multipart form)\
+holds the input to be tagged; the response body holds the tagged output.\n\
+GET /stats returns per-stage timings of all requests served so far (JSON).\n\
+\n\
+Use --workers to tag several requests at once; the workers share the loaded\
+model and each keeps only its own decoding state.\n";
+
+prog_opts::variables_map parse_options(int argc, char** argv);
+std::vector<TaggerPtr> create_taggers(const prog_opts::variables_map& var_map);
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		prog_opts::variables_map var_map = parse_options(argc, argv);
+		TaggingServer server(create_taggers(var_map),
+							 var_map["input-format"].as<std::string>(),
+							 var_map["output-format"].as<std::string>(),
+							 var_map["max-request-mb"].as<size_t>() * 1024 * 1024,
+							 var_map["timeout"].as<long>(),
+							 var_map["max-queue"].as<size_t>());
+
+		const std::string socket_path = var_map["socket"].as<std::string>();
+		if(!socket_path.empty())
+			server.serve_unix(socket_path);
+		else
+			server.serve_tcp(var_map["port"].as<unsigned short>());
+	} catch (Wcrft::FileNotFound &e) {
+		std::cerr << "Error: " << e.info() << std::endl;
+		return 1;
+	} catch (Corpus2::Corpus2Error &e) {
+		std::cerr << "Error: " << e.info() << std::endl;
+		return 1;
+	} catch (std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+prog_opts::variables_map parse_options(int argc, char** argv)
+{
+	prog_opts::options_description desc(DESCRIPTION);
+	desc.add_options()
+		("help,h", "Print help message")
+		("input-format,i", prog_opts::value<std::string>()->default_value("premorph"), "set the input format")
+		("output-format,o", prog_opts::value<std::string>()->default_value("ccl"), "set the output format")
+		("data-dir,d", prog_opts::value<std::string>()->default_value(""), "search for trainedmodel in the given dir")
+		("maca-config,mc", prog_opts::value<std::string>()->default_value(""), "overrides maca config file")
+		("wccl-config,wc", prog_opts::value<std::string>()->default_value(""), "overrides wccl config file")
+		("ambiguity,A", prog_opts::bool_switch(), "preserve non-disamb interpretations after tagging")
+		("sent-only,S", prog_opts::bool_switch(), "read sentence-by-sentence and ignore paragraphs")
+		("port,p", prog_opts::value<unsigned short>()->default_value(8088), "TCP port to listen on")
+		("socket,s", prog_opts::value<std::string>()->default_value(""), "listen on Unix domain socket at given path instead of TCP port")
+		("workers,w", prog_opts::value<unsigned int>()->default_value(1), "number of requests tagged at once")
+		("threads,t", prog_opts::value<int>()->default_value(1), "number of tagging threads used by each worker")
+		("max-request-mb", prog_opts::value<size_t>()->default_value(64), "reject requests with larger body (in MB)")
+		("timeout", prog_opts::value<long>()->default_value(60), "seconds allowed for receiving a request and for sending the response")
+		("max-queue", prog_opts::value<size_t>()->default_value(64), "connections waiting for a worker before no more are accepted")
+		("config", prog_opts::value<std::string>()->required(), "Tagger configuration file")
+	;
+	prog_opts::positional_options_description positional_desc;
+	positional_desc.add("config", 1);
+
+	prog_opts::variables_map var_map;
+	try {
+		prog_opts::store(prog_opts::command_line_parser(argc, argv)
+									.options(desc)
+									.positional(positional_desc)
+									.run(), var_map);
+
+		if(var_map.count("help")) {
+			std::cout << desc << std::endl << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+
+		prog_opts::notify(var_map);
+	} catch (prog_opts::error& e) {
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		std::cerr << desc << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	if(var_map["workers"].as<unsigned int>() == 0) {
+		std::cerr << "ERROR: at least one worker is needed" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	if(var_map["max-queue"].as<size_t>() == 0) {
+		std::cerr << "ERROR: max-queue must be positive" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	if(var_map["timeout"].as<long>() <= 0) {
+		std::cerr << "ERROR: timeout must be positive" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	return var_map;
+}
+
+std::vector<TaggerPtr> create_taggers(const prog_opts::variables_map& var_map)
+{
+	const std::string config_path = var_map["config"].as<std::string>();
+	const std::string data_dir = var_map["data-dir"].as<std::string>();
+	const std::string maca_config = var_map["maca-config"].as<std::string>();
+	const std::string wccl_config = var_map["wccl-config"].as<std::string>();
+
+	TaggerPtr tagger = boost::make_shared<Wcrft::Tagger>(config_path, data_dir);
+	tagger->switch_paragraph_processing(!var_map["sent-only"].as<bool>());
+	tagger->switch_preserve_ambiguity(var_map["ambiguity"].as<bool>());
+	tagger->set_threads(var_map["threads"].as<int>());
+	if(!maca_config.empty())
+		tagger->set_maca_config(maca_config);
+	if(!wccl_config.empty())
+		tagger->set_wccl_config(wccl_config);
+	tagger->load_model();
+
+	// the model is loaded once, other workers share it
+	std::vector<TaggerPtr> taggers;
+	taggers.push_back(tagger);
+	for(unsigned int i = 1; i < var_map["workers"].as<unsigned int>(); ++i) {
+		TaggerPtr worker = tagger->create_worker();
+		worker->set_threads(var_map["threads"].as<int>());
+		taggers.push_back(worker);
+	}
+
+	return taggers;
+}
@@ -0,0 +1,361 @@
+/* This file is part of WCRFT
+  Copyright (C) 2014 Radosław Warzocha, Adam Radziszewski.
+  WCRFT is free software; you can redistribute and/or modify it
+  under the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 3 of the License, or (at your option)
+  any later version.
+
+  WCRFT is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.
+
+  See the LICENCE and COPYING files for more details
+ */
+
+#include <cstdio>
+#include <sstream>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/asio.hpp>
+#include <boost/version.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "server.h"
+
+namespace details {
+
+const std::string CRLF = "\r\n";
+
+struct Request {
+	std::string method;
+	std::string path;
+	std::string content_type;
+	std::string body;
+	/// status to respond with if the request is not acceptable, else empty
+	std::string error;
+};
+
+/// Read line terminated with LF, stripping trailing CR.
+bool read_line(std::istream& is, std::string& line)
+{
+	if(!std::getline(is, line))
+		return false;
+	if(!line.empty() && line[line.size() - 1] == '\r')
+		line.erase(line.size() - 1);
+	return true;
+}
+
+/**
+ * Parse Content-Length header value into @a length. Returns the status to
+ * respond with if the value is not a number or exceeds @a max_length,
+ * empty string otherwise.
+ */
+std::string parse_content_length(const std::string& value, size_t max_length,
+								 size_t& length)
+{
+	if(value.empty() || !boost::algorithm::all(value, boost::algorithm::is_digit()))
+		return "400 Bad Request";
+	length = 0;
+	BOOST_FOREACH(char c, value) {
+		length = length * 10 + (c - '0');
+		if(length > max_length)
+			return "413 Request Entity Too Large";
+	}
+	return "";
+}
+
+/**
+ * Read request line, headers and body of at most @a max_body bytes.
+ * Returns false if there is no request to respond to; a request that is
+ * read but can't be accepted has its error status set.
+ */
+bool read_request(std::istream& is, Request& request, size_t max_body)
+{
+	std::string line;
+	if(!read_line(is, line))
+		return false;
+	std::istringstream request_line(line);
+	request_line >> request.method >> request.path;
+
+	size_t content_length = 0;
+	while(read_line(is, line) && !line.empty()) {
+		std::string::size_type colon = line.find(':');
+		if(colon == std::string::npos)
+			continue;
+		std::string name = boost::algorithm::to_lower_copy(line.substr(0, colon));
+		std::string value = boost::algorithm::trim_copy(line.substr(colon + 1));
+		if(name == "content-length") {
+			request.error = parse_content_length(value, max_body, content_length);
+			if(!request.error.empty())
+				return true;
+		}
+		else if(name == "content-type")
+			request.content_type = value;
+	}
+
+	if(content_length > 0) {
+		request.body.resize(content_length);
+		is.read(&request.body[0], content_length);
+		if(static_cast<size_t>(is.gcount()) != content_length)
+			// the client closed the connection or timed out
+			request.error = "400 Bad Request";
+	}
+	return true;
+}
+
+/**
+ * Return the contents of the "file" field of a multipart/form-data body
+ * (the first field if there is no such name) or the whole body if the
+ * request is not multipart.
+ */
+std::string extract_input(const Request& request)
+{
+	static const std::string BOUNDARY_PARAM = "boundary=";
+
+	if(!boost::algorithm::istarts_with(request.content_type, "multipart/form-data"))
+		return request.body;
+	std::string::size_type param_pos = request.content_type.find(BOUNDARY_PARAM);
+	if(param_pos == std::string::npos)
+		return request.body;
+
+	std::string boundary = request.content_type.substr(
+				param_pos + BOUNDARY_PARAM.size());
+	boundary = boundary.substr(0, boundary.find(';'));
+	boost::algorithm::trim_if(boundary, boost::algorithm::is_any_of("\" "));
+	const std::string delimiter = "--" + boundary;
+
+	std::string first_part;
+	bool have_first = false;
+	std::string::size_type pos = request.body.find(delimiter);
+	while(pos != std::string::npos) {
+		pos += delimiter.size();
+		if(request.body.compare(pos, 2, "--") == 0)
+			break; // closing delimiter
+		std::string::size_type headers_end = request.body.find(CRLF + CRLF, pos);
+		if(headers_end == std::string::npos)
+			break;
+		std::string::size_type next = request.body.find(CRLF + delimiter, headers_end);
+		if(next == std::string::npos)
+			break;
+
+		const std::string headers = request.body.substr(pos, headers_end - pos);
+		const std::string::size_type data_begin = headers_end + 2 * CRLF.size();
+		const std::string data = request.body.substr(data_begin, next - data_begin);
+		if(boost::algorithm::icontains(headers, "name=\"file\""))
+			return data;
+		if(!have_first) {
+			first_part = data;
+			have_first = true;
+		}
+		pos = next + CRLF.size();
+	}
+	return have_first ? first_part : request.body;
+}
+
+void write_response(std::ostream& os, const std::string& status,
+					const std::string& content_type, const std::string& body)
+{
+	os << "HTTP/1.0 " << status << CRLF
+	   << "Content-Type: " << content_type << CRLF
+	   << "Content-Length: " << body.size() << CRLF
+	   << "Connection: close" << CRLF
+	   << CRLF
+	   << body;
+	os.flush();
+}
+
+/**
+ * Content type of the output written in given Corpus2 format.
+ */
+std::string output_content_type(const std::string& output_format)
+{
+	if(boost::algorithm::starts_with(output_format, "readability"))
+		return "application/json; charset=utf-8";
+	return "text/xml; charset=utf-8";
+}
+
+/**
+ * Make I/O on the connection fail once given number of seconds pass.
+ * (Socket options such as SO_RCVTIMEO have no effect on Asio streams,
+ * which wait for the socket to become ready by themselves.)
+ */
+template<typename Stream>
+void expire_after(Stream* stream, long seconds)
+{
+#if BOOST_VERSION >= 106600
+	stream->expires_after(boost::asio::chrono::seconds(seconds));
+#else
+	stream->expires_from_now(boost::posix_time::seconds(seconds));
+#endif
+}
+
+} /* end ns details */
+
+TaggingServer::TaggingServer(const std::vector<TaggerPtr>& taggers,
+							 const std::string& input_format,
+							 const std::string& output_format,
+							 size_t max_request_size, long timeout, size_t max_queue)
+	: taggers_(taggers), input_format_(input_format), output_format_(output_format),
+	  max_request_size_(max_request_size), timeout_(timeout), max_queue_(max_queue)
+{
+}
+
+void TaggingServer::serve_tcp(unsigned short port)
+{
+	using boost::asio::ip::tcp;
+	boost::asio::io_service io_service;
+	tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), port));
+	this->start_workers();
+	this->accept_loop<tcp>(acceptor);
+}
+
+void TaggingServer::serve_unix(const std::string& socket_path)
+{
+	using boost::asio::local::stream_protocol;
+	// remove stale socket left by previous instance
+	std::remove(socket_path.c_str());
+	boost::asio::io_service io_service;
+	stream_protocol::acceptor acceptor(io_service, stream_protocol::endpoint(socket_path));
+	this->start_workers();
+	this->accept_loop<stream_protocol>(acceptor);
+}
+
+template<typename Protocol>
+void TaggingServer::accept_loop(typename Protocol::acceptor& acceptor)
+{
+	typedef typename Protocol::iostream Stream;
+	bool failing = false;
+	while(true) {
+		boost::shared_ptr<Stream> stream = boost::make_shared<Stream>();
+		boost::system::error_code error;
+		acceptor.accept(*stream->rdbuf(), error);
+		if(error) {
+			// e.g. out of file descriptors: report once and retry later
+			// instead of spinning
+			if(!failing)
+				std::cerr << "Error accepting connection: " << error.message() << std::endl;
+			failing = true;
+			boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+			continue;
+		}
+		failing = false;
+		Connection connection;
+		connection.stream = stream;
+		connection.expire_after =
+				boost::bind(&details::expire_after<Stream>, stream.get(), _1);
+		this->push_connection(connection);
+	}
+}
+
+void TaggingServer::start_workers()
+{
+	BOOST_FOREACH(TaggerPtr tagger, taggers_) {
+		boost::thread worker(boost::bind(&TaggingServer::worker_loop, this, tagger));
+		worker.detach();
+	}
+}
+
+void TaggingServer::worker_loop(TaggerPtr tagger)
+{
+	while(true) {
+		Connection connection = this->pop_connection();
+		// a failure with one connection must not end the worker
+		try {
+			this->handle_connection(*tagger, connection);
+		} catch(std::exception& e) {
+			std::cerr << "Error handling connection: " << e.what() << std::endl;
+		} catch(...) {
+			std::cerr << "Error handling connection" << std::endl;
+		}
+	}
+}
+
+void TaggingServer::push_connection(const Connection& connection)
+{
+	boost::mutex::scoped_lock lock(pending_mutex_);
+	while(pending_.size() >= max_queue_)
+		pending_cond_.wait(lock);
+	pending_.push_back(connection);
+	pending_cond_.notify_all();
+}
+
+TaggingServer::Connection TaggingServer::pop_connection()
+{
+	boost::mutex::scoped_lock lock(pending_mutex_);
+	while(pending_.empty())
+		pending_cond_.wait(lock);
+	Connection connection = pending_.front();
+	pending_.pop_front();
+	pending_cond_.notify_all();
+	return connection;
+}
+
+void TaggingServer::handle_connection(Wcrft::Tagger& tagger, const Connection& client)
+{
+	std::iostream& connection = *client.stream;
+	// the time spent waiting in the queue doesn't count
+	client.expire_after(timeout_);
+	details::Request request;
+	if(!details::read_request(connection, request, max_request_size_))
+		return;
+	// tagging isn't limited, sending the output has its own time
+	client.expire_after(timeout_);
+
+	if(!request.error.empty()) {
+		const std::string message = boost::algorithm::starts_with(request.error, "413")
+				? "Request body larger than "
+				  + boost::lexical_cast<std::string>(max_request_size_) + " bytes.\n"
+				: "Invalid Content-Length or incomplete request body.\n";
+		details::write_response(connection, request.error,
+								"text/plain; charset=utf-8", message);
+		return;
+	}
+
+	if(request.method == "GET" && request.path == "/stats") {
+		std::ostringstream stats;
+		{
+			boost::mutex::scoped_lock lock(stats_mutex_);
+			stats_.write_json(stats);
+		}
+		stats << "\n";
+		details::write_response(connection, "200 OK",
+								"application/json; charset=utf-8", stats.str());
+		return;
+	}
+
+	if(request.method != "POST") {
+		details::write_response(connection, "405 Method Not Allowed",
+								"text/plain; charset=utf-8",
+								"Only POST requests (and GET /stats) are accepted.\n");
+		return;
+	}
+
+	std::istringstream input(details::extract_input(request));
+	std::ostringstream output;
+	try {
+		tagger.tag_input(input, input_format_, output, output_format_);
+	} catch(PwrNlp::PwrNlpError& e) {
+		details::write_response(connection, "500 Internal Server Error",
+								"text/plain; charset=utf-8", e.info() + "\n");
+		return;
+	} catch(std::exception& e) {
+		details::write_response(connection, "500 Internal Server Error",
+								"text/plain; charset=utf-8", std::string(e.what()) + "\n");
+		return;
+	}
+
+	{
+		boost::mutex::scoped_lock lock(stats_mutex_);
+		stats_.merge(tagger.get_statistics());
+	}
+
+	details::write_response(connection, "200 OK",
+							details::output_content_type(output_format_), output.str());
+}
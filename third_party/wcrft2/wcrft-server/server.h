@@ -0,0 +1,120 @@
+/* This file is part of WCRFT
+  Copyright (C) 2014 Radosław Warzocha, Adam Radziszewski.
+  WCRFT is free software; you can redistribute and/or modify it
+  under the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 3 of the License, or (at your option)
+  any later version.
+
+  WCRFT is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.
+
+  See the LICENCE and COPYING files for more details
+ */
+
+/**
+ * @file server.h
+ * @brief Minimal HTTP server keeping loaded tagger instances resident.
+ */
+
+#ifndef WCRFT_SERVER_H
+#define WCRFT_SERVER_H
+
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <libwcrft/tagger.h>
+
+typedef boost::shared_ptr<Wcrft::Tagger> TaggerPtr;
+
+/**
+ * @brief Serves tagging requests using tagger instances that are loaded once.
+ *
+ * Each request is a HTTP POST whose body (or the "file" field of
+ * a multipart/form-data body) contains the input to be tagged; the tagged
+ * output is sent back as the response body and the connection is closed.
+ *
+ * One worker thread is started per given tagger, so that as many connections
+ * as there are taggers are served at once. Connections that arrive while all
+ * workers are busy wait in a queue. Taggers must have their model loaded
+ * before the server is started (e.g. one loaded tagger and the others made
+ * with Tagger::create_worker, sharing its model); each is only ever used by
+ * its own worker.
+ *
+ * A GET request for /stats returns the counts and stage timings of all
+ * requests tagged since the server was started, as JSON.
+ *
+ * Requests with an invalid Content-Length or a body above the size limit
+ * are rejected. Reading a request and sending a response each have to
+ * finish within the timeout, so that idle or slow clients don't keep
+ * workers from serving others.
+ *
+ * At most max_queue accepted connections wait for a worker; while the
+ * queue is full, no more connections are accepted and new clients wait
+ * in the listen backlog of the system, so that a burst of clients does
+ * not use up file descriptors.
+ */
+class TaggingServer {
+public:
+	/**
+	 * @param taggers Tagger instances with model loaded, one per worker.
+	 * @param input_format Corpus2-compliant (or txt/premorph) input format.
+	 * @param output_format Corpus2-compliant output format.
+	 * @param max_request_size Largest accepted request body, in bytes.
+	 * @param timeout Time allowed for reading a request and for sending
+	 *        a response, in seconds.
+	 * @param max_queue Most accepted connections waiting for a worker.
+	 */
+	TaggingServer(const std::vector<TaggerPtr>& taggers,
+				  const std::string& input_format,
+				  const std::string& output_format,
+				  size_t max_request_size, long timeout, size_t max_queue);
+
+	/// Accept connections on given TCP port (all interfaces), never returns.
+	void serve_tcp(unsigned short port);
+
+	/// Accept connections on Unix domain socket at given path, never returns.
+	void serve_unix(const std::string& socket_path);
+
+private:
+	/// Accepted connection and a way to set a deadline for its I/O.
+	struct Connection {
+		boost::shared_ptr<std::iostream> stream;
+		boost::function<void (long)> expire_after;
+	};
+
+	template<typename Protocol>
+	void accept_loop(typename Protocol::acceptor& acceptor);
+
+	void start_workers();
+	void worker_loop(TaggerPtr tagger);
+
+	void push_connection(const Connection& connection);
+	Connection pop_connection();
+
+	void handle_connection(Wcrft::Tagger& tagger, const Connection& client);
+
+	std::vector<TaggerPtr> taggers_;
+	std::string input_format_, output_format_;
+	size_t max_request_size_;
+	long timeout_;
+	size_t max_queue_;
+
+	/// statistics of all tagged requests, merged from the taggers
+	Wcrft::Statistics stats_;
+	boost::mutex stats_mutex_;
+
+	std::deque<Connection> pending_;
+	boost::mutex pending_mutex_;
+	/// signalled when a connection is added to or taken from pending_
+	boost::condition_variable pending_cond_;
+};
+
+#endif // WCRFT_SERVER_H